@@ -0,0 +1,102 @@
+#include "gpu_sort.h"
+
+#include <stdexcept>
+#include <cuda_runtime.h>
+#include <thrust/device_vector.h>
+#include <thrust/gather.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+
+
+namespace {
+
+/**
+ * @brief Преобразует код ошибки CUDA в исключение.
+ * @throws std::runtime_error Если status не равен cudaSuccess.
+ */
+void checkCuda(cudaError_t status, const char* operation) {
+    if (status != cudaSuccess) {
+        throw std::runtime_error(std::string("Ошибка: CUDA (") + operation + "): " + cudaGetErrorString(status));
+    }
+}
+
+
+/**
+ * @brief Событие CUDA для замера времени на устройстве.
+ */
+class CudaEvent {
+public:
+    CudaEvent() { checkCuda(cudaEventCreate(&event), "cudaEventCreate"); }
+    ~CudaEvent() { cudaEventDestroy(event); }
+
+    CudaEvent(const CudaEvent&) = delete;
+    CudaEvent& operator=(const CudaEvent&) = delete;
+
+    void record() { checkCuda(cudaEventRecord(event), "cudaEventRecord"); }
+
+    /**
+     * @brief Возвращает время в миллисекундах от события start до этого события.
+     */
+    double elapsedSince(const CudaEvent& start) const {
+        float ms = 0.0f;
+        checkCuda(cudaEventElapsedTime(&ms, start.event, event), "cudaEventElapsedTime");
+        return ms;
+    }
+
+    void synchronize() { checkCuda(cudaEventSynchronize(event), "cudaEventSynchronize"); }
+
+private:
+    cudaEvent_t event = nullptr;
+};
+
+}
+
+
+bool gpuSortAvailable(std::string* deviceName) {
+    int count = 0;
+    if (cudaGetDeviceCount(&count) != cudaSuccess || count == 0) {
+        cudaGetLastError();   // Сбрасываем ошибку, чтобы она не всплыла в следующем вызове
+        return false;
+    }
+    cudaDeviceProp properties;
+    if (deviceName && cudaGetDeviceProperties(&properties, 0) == cudaSuccess) {
+        *deviceName = properties.name;
+    }
+    return true;
+}
+
+
+void gpuSortKeys(const uint64_t* primary, const uint64_t* secondary, size_t n, uint32_t* permutation,
+                 GpuSortTimings& timings) {
+    timings.uploadMs = timings.kernelMs = timings.downloadMs = 0.0;
+    if (n == 0) return;
+
+    CudaEvent start;
+    CudaEvent uploaded;
+    CudaEvent sorted;
+    CudaEvent downloaded;
+
+    start.record();
+    thrust::device_vector<uint64_t> primaryKeys(primary, primary + n);
+    thrust::device_vector<uint64_t> secondaryKeys(secondary, secondary + n);
+    uploaded.record();
+
+    // LSD по двум ключам: устойчивая поразрядная сортировка Thrust по младшему ключу,
+    // затем по старшему ключу, переставленному в полученном порядке.
+    thrust::device_vector<uint32_t> indices(n);
+    thrust::sequence(indices.begin(), indices.end());
+    thrust::stable_sort_by_key(secondaryKeys.begin(), secondaryKeys.end(), indices.begin());
+    thrust::device_vector<uint64_t> primaryInOrder(n);
+    thrust::gather(indices.begin(), indices.end(), primaryKeys.begin(), primaryInOrder.begin());
+    thrust::stable_sort_by_key(primaryInOrder.begin(), primaryInOrder.end(), indices.begin());
+    sorted.record();
+
+    checkCuda(cudaMemcpy(permutation, thrust::raw_pointer_cast(indices.data()), n * sizeof(uint32_t),
+                         cudaMemcpyDeviceToHost), "cudaMemcpy");
+    downloaded.record();
+    downloaded.synchronize();
+
+    timings.uploadMs = uploaded.elapsedSince(start);
+    timings.kernelMs = sorted.elapsedSince(uploaded);
+    timings.downloadMs = downloaded.elapsedSince(sorted);
+}
@@ -0,0 +1,45 @@
+#ifndef SORT_BENCH_GPU_SORT_H
+#define SORT_BENCH_GPU_SORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/**
+ * @brief Время этапов GPU-сортировки в миллисекундах.
+ * Этапы устройства (upload, kernel, download) измеряются событиями CUDA в gpuSortKeys,
+ * этапы хоста (extract, permute) - в gpuSort.
+ */
+struct GpuSortTimings {
+    double extractMs = 0.0;    ///< Извлечение ключей из записей на хосте
+    double uploadMs = 0.0;     ///< Выделение памяти устройства и копирование ключей хост -> устройство
+    double kernelMs = 0.0;     ///< Сортировка ключей на устройстве
+    double downloadMs = 0.0;   ///< Копирование перестановки устройство -> хост
+    double permuteMs = 0.0;    ///< Досортировка равных ключей и перестановка записей на хосте
+};
+
+
+/**
+ * @brief Проверяет, доступно ли устройство CUDA.
+ * @param deviceName Название устройства 0 (выходной параметр, может быть nullptr).
+ * @return True, если найдено хотя бы одно устройство.
+ */
+bool gpuSortAvailable(std::string* deviceName);
+
+
+/**
+ * @brief Сортирует 128-битные ключи (primary - старшие 64 бита, secondary - младшие) на GPU.
+ * На устройство передаются только ключи, обратно - только перестановка; записи остаются на хосте.
+ * Сортировка устойчивая: записи с равными ключами сохраняют исходный порядок.
+ * @param primary Старшие части ключей (n элементов).
+ * @param secondary Младшие части ключей (n элементов).
+ * @param n Количество ключей (меньше 2^32).
+ * @param permutation Индексы записей в отсортированном порядке (выходной массив из n элементов).
+ * @param timings Время этапов upload, kernel и download (остальные поля не изменяются).
+ * @throws std::runtime_error При ошибке CUDA.
+ */
+void gpuSortKeys(const uint64_t* primary, const uint64_t* secondary, size_t n, uint32_t* permutation,
+                 GpuSortTimings& timings);
+
+#endif
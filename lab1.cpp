@@ -8,10 +8,347 @@
 #include <stdexcept>
 #include <iomanip>    // Для std::fixed, std::setprecision
 #include <utility>    // Для std::move
+#include <string_view>
+#include <charconv>   // Для std::from_chars, std::to_chars
+#include <cstring>    // Для std::memchr
+#include <thread>
+#include <cstdint>
+#include <array>
+#include <cmath>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <filesystem>
+#include <optional>
+#include <map>
+#include <random>
+#include <cstdlib>    // Для std::malloc, std::free
+#include <new>
+#include <exception>  // Для std::exception_ptr
+#include <locale>     // Для std::collate
+#include <limits>
+#include <set>
+#include <tuple>      // Для std::apply
+#if __has_include(<execution>)
+#include <execution>
+#endif
+#if defined(__GLIBCXX__) && __has_include(<tbb/global_control.h>)
+#include <tbb/global_control.h>
+#define SORT_BENCH_HAVE_TBB_CONTROL 1
+#endif
 #include <locale.h>
+#ifdef SORT_BENCH_HAVE_CUDA
+#include "gpu_sort.h"
+#endif
+#ifdef SORT_BENCH_HAVE_MPI
+#include <mpi.h>
+#endif
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64)
+#define SORT_BENCH_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SORT_BENCH_TARGET(isa)
+#else
+#define SORT_BENCH_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+#ifdef SORT_BENCH_TRACK_ALLOCATIONS
+#if defined(__GLIBC__) || defined(_WIN32)
+#include <malloc.h>
+#define SORT_BENCH_HAVE_ALLOCATION_TRACKING 1
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define SORT_BENCH_HAVE_ALLOCATION_TRACKING 1
+#endif
+#ifdef _MSC_VER
+#define SORT_BENCH_NOINLINE __declspec(noinline)
+#else
+#define SORT_BENCH_NOINLINE __attribute__((noinline))
+#endif
+#endif
 
 
+/**
+ * @brief Счетчики операций над Service (сравнения, обмены, перемещения/копирования).
+ *
+ * Включаются макросом SORT_BENCH_COUNT_OPERATIONS при компиляции. Без него макрос
+ * SORT_BENCH_COUNT раскрывается в пустое выражение, а Service использует неявные
+ * конструкторы копирования и перемещения, поэтому накладных расходов нет.
+ */
+#ifdef SORT_BENCH_COUNT_OPERATIONS
+struct OperationCounters {
+    static inline std::atomic<uint64_t> comparisons{0};  ///< Вызовы operator< и operator==
+    static inline std::atomic<uint64_t> swaps{0};        ///< Вызовы swap
+    static inline std::atomic<uint64_t> moves{0};        ///< Копирования и перемещения записей
+};
+#define SORT_BENCH_COUNT(counter) (OperationCounters::counter.fetch_add(1, std::memory_order_relaxed))
+#else
+#define SORT_BENCH_COUNT(counter) ((void)0)
+#endif
+
+
+/**
+ * @brief Снимок счетчиков операций.
+ */
+struct OperationCounts {
+    bool enabled = false;       ///< True, если программа собрана с SORT_BENCH_COUNT_OPERATIONS
+    uint64_t comparisons = 0;   ///< Количество сравнений
+    uint64_t swaps = 0;         ///< Количество обменов
+    uint64_t moves = 0;         ///< Количество копирований и перемещений
+};
+
+
+/**
+ * @brief Обнуляет счетчики операций (ничего не делает без SORT_BENCH_COUNT_OPERATIONS).
+ */
+inline void resetOperationCounters() {
+#ifdef SORT_BENCH_COUNT_OPERATIONS
+    OperationCounters::comparisons = 0;
+    OperationCounters::swaps = 0;
+    OperationCounters::moves = 0;
+#endif
+}
+
+
+/**
+ * @brief Считывает текущие значения счетчиков операций.
+ * @return Снимок счетчиков; поле enabled равно false, если подсчет отключен при компиляции.
+ */
+inline OperationCounts readOperationCounters() {
+    OperationCounts counts;
+#ifdef SORT_BENCH_COUNT_OPERATIONS
+    counts.enabled = true;
+    counts.comparisons = OperationCounters::comparisons.load();
+    counts.swaps = OperationCounters::swaps.load();
+    counts.moves = OperationCounters::moves.load();
+#endif
+    return counts;
+}
+
+
+/**
+ * @brief Учет памяти, выделенной через operator new (количество выделений, объем, текущий объем и пик).
+ *
+ * Включается макросом SORT_BENCH_TRACK_ALLOCATIONS при компиляции: глобальные operator new/delete
+ * заменяются тонкой оберткой над malloc/free, а размер блока берется из распределителя
+ * (malloc_usable_size, _msize, malloc_size), поэтому заголовки к блокам не добавляются.
+ * Без макроса, а также на платформах без такой функции, operator new не заменяется
+ * (SORT_BENCH_HAVE_ALLOCATION_TRACKING не определен), и замеры времени не платят за учет.
+ */
+struct AllocationCounters {
+    static inline std::atomic<uint64_t> allocations{0};     ///< Всего вызовов operator new
+    static inline std::atomic<uint64_t> allocatedBytes{0};  ///< Всего выделено (байт)
+    static inline std::atomic<size_t> currentBytes{0};      ///< Выделено и не освобождено (байт)
+    static inline std::atomic<size_t> peakBytes{0};         ///< Максимум currentBytes с начала текущего AllocationScope
+};
+
+
+#ifdef SORT_BENCH_HAVE_ALLOCATION_TRACKING
+/**
+ * @brief Возвращает фактический размер блока, выделенного malloc.
+ */
+inline size_t allocationBlockSize(void* block) {
+#if defined(_WIN32)
+    return _msize(block);
+#elif defined(__APPLE__)
+    return malloc_size(block);
+#else
+    return malloc_usable_size(block);
+#endif
+}
+
+
+/**
+ * @brief Выделяет блок через malloc и учитывает его в AllocationCounters.
+ * @return Указатель на блок или nullptr, если памяти недостаточно.
+ */
+inline void* trackedAllocate(size_t size) {
+    void* block = std::malloc(size ? size : 1);
+    if (block == nullptr) return nullptr;
+    size_t bytes = allocationBlockSize(block);
+    AllocationCounters::allocations.fetch_add(1, std::memory_order_relaxed);
+    AllocationCounters::allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    size_t now = AllocationCounters::currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = AllocationCounters::peakBytes.load(std::memory_order_relaxed);
+    while (now > peak && !AllocationCounters::peakBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+    return block;
+}
+
+
+/**
+ * @brief Освобождает блок, выделенный trackedAllocate.
+ * Не встраивается: иначе GCC видит free() для указателя из operator new и выдает -Wmismatched-new-delete.
+ */
+SORT_BENCH_NOINLINE void trackedFree(void* block) noexcept {
+    if (block == nullptr) return;
+    AllocationCounters::currentBytes.fetch_sub(allocationBlockSize(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+
+void* operator new(std::size_t size) {
+    void* block;
+    while ((block = trackedAllocate(size)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) throw std::bad_alloc();
+        handler();
+    }
+    return block;
+}
+
+void* operator new[](std::size_t size) { return ::operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size); }
+void operator delete(void* block) noexcept { trackedFree(block); }
+void operator delete[](void* block) noexcept { trackedFree(block); }
+void operator delete(void* block, std::size_t) noexcept { trackedFree(block); }
+void operator delete[](void* block, std::size_t) noexcept { trackedFree(block); }
+void operator delete(void* block, const std::nothrow_t&) noexcept { trackedFree(block); }
+void operator delete[](void* block, const std::nothrow_t&) noexcept { trackedFree(block); }
+#endif
+
+
+/**
+ * @brief Возвращает true, если программа учитывает выделения памяти.
+ */
+constexpr bool allocationTrackingEnabled() {
+#ifdef SORT_BENCH_HAVE_ALLOCATION_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/**
+ * @brief Сбрасывает пиковый резидентный объем процесса (Linux: /proc/self/clear_refs).
+ * На других платформах пик не сбрасывается и остается максимумом за время работы процесса.
+ */
+inline void resetPeakResidentBytes() {
+#ifdef __linux__
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs) clearRefs << "5";
+#endif
+}
+
+
+/**
+ * @brief Возвращает пиковый резидентный объем процесса (байт) или 0, если он недоступен.
+ * Linux: VmHWM из /proc/self/status; Windows: PeakWorkingSetSize; остальные: getrusage.
+ */
+inline size_t peakResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return static_cast<size_t>(std::strtoull(line.c_str() + 6, nullptr, 10)) * 1024;
+        }
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+
+/**
+ * @brief Выделения памяти за этап работы (загрузка, копирование, сортировка, сохранение).
+ */
+struct AllocationStats {
+    uint64_t allocations = 0;   ///< Количество вызовов operator new
+    uint64_t bytes = 0;         ///< Объем выделенной памяти (байт, без учета освобождений)
+    size_t peakExtraBytes = 0;  ///< Наибольший прирост выделенной и не освобожденной памяти (байт)
+    size_t peakRssBytes = 0;    ///< Пиковый резидентный объем процесса на этапе (байт, 0 - недоступен)
+
+    /**
+     * @brief Объединяет замеры нескольких запусков одного этапа (по максимуму каждого поля).
+     */
+    void combineMax(const AllocationStats& other) {
+        allocations = std::max(allocations, other.allocations);
+        bytes = std::max(bytes, other.bytes);
+        peakExtraBytes = std::max(peakExtraBytes, other.peakExtraBytes);
+        peakRssBytes = std::max(peakRssBytes, other.peakRssBytes);
+    }
+};
+
+
+/**
+ * @brief Измеряет выделения памяти с момента создания: количество, объем, пик сверх исходного объема и пиковый RSS.
+ * Пики общие для всех потоков и всего процесса, поэтому одновременно должен действовать только один замер.
+ */
+class AllocationScope {
+public:
+    AllocationScope() {
+        resetPeakResidentBytes();   // Сам сброс выделяет память, поэтому выполняется до снимка счетчиков
+        startAllocations = AllocationCounters::allocations.load(std::memory_order_relaxed);
+        startBytes = AllocationCounters::allocatedBytes.load(std::memory_order_relaxed);
+        baseline = AllocationCounters::currentBytes.load(std::memory_order_relaxed);
+        AllocationCounters::peakBytes.store(baseline, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Возвращает пик выделенной памяти сверх исходного объема (байт).
+     */
+    size_t peakExtraBytes() const {
+        size_t peak = AllocationCounters::peakBytes.load(std::memory_order_relaxed);
+        return peak > baseline ? peak - baseline : 0;
+    }
+
+    /**
+     * @brief Возвращает статистику выделений с момента создания.
+     */
+    AllocationStats stats() const {
+        AllocationStats result;
+        result.allocations = AllocationCounters::allocations.load(std::memory_order_relaxed) - startAllocations;
+        result.bytes = AllocationCounters::allocatedBytes.load(std::memory_order_relaxed) - startBytes;
+        result.peakExtraBytes = peakExtraBytes();
+        result.peakRssBytes = peakResidentBytes();
+        return result;
+    }
+
+private:
+    uint64_t startAllocations = 0;
+    uint64_t startBytes = 0;
+    size_t baseline = 0;
+};
+
 /**
  * @brief Представляет IT-услугу с ее свойствами.
  *
@@ -40,6 +377,53 @@ struct Service {
     Service(std::string n, double c, int d, double p)
         : name(std::move(n)), cost(c), duration(d), prepayment(p) {}
 
+#ifdef SORT_BENCH_COUNT_OPERATIONS
+    /**
+     * @brief Конструкторы и операторы копирования/перемещения с подсчетом (только в режиме инструментирования).
+     */
+    Service(const Service& other)
+        : name(other.name), cost(other.cost), duration(other.duration), prepayment(other.prepayment) {
+        SORT_BENCH_COUNT(moves);
+    }
+
+    Service(Service&& other) noexcept
+        : name(std::move(other.name)), cost(other.cost), duration(other.duration), prepayment(other.prepayment) {
+        SORT_BENCH_COUNT(moves);
+    }
+
+    Service& operator=(const Service& other) {
+        SORT_BENCH_COUNT(moves);
+        name = other.name;
+        cost = other.cost;
+        duration = other.duration;
+        prepayment = other.prepayment;
+        return *this;
+    }
+
+    Service& operator=(Service&& other) noexcept {
+        SORT_BENCH_COUNT(moves);
+        name = std::move(other.name);
+        cost = other.cost;
+        duration = other.duration;
+        prepayment = other.prepayment;
+        return *this;
+    }
+#endif
+
+    /**
+     * @brief Обменивает содержимое двух услуг поэлементно.
+     * Находится через ADL, поэтому используется как в собственных сортировках, так и в std::sort.
+     * @param a Первая услуга.
+     * @param b Вторая услуга.
+     */
+    friend void swap(Service& a, Service& b) noexcept {
+        SORT_BENCH_COUNT(swaps);
+        a.name.swap(b.name);
+        std::swap(a.cost, b.cost);
+        std::swap(a.duration, b.duration);
+        std::swap(a.prepayment, b.prepayment);
+    }
+
     /**
      * @brief Оператор "меньше" (<).
      * Сравнивает услуги сначала по стоимости, затем по предоплате, затем по названию.
@@ -47,6 +431,7 @@ struct Service {
      * @return True, если текущая услуга "меньше" другой, иначе false.
      */
     bool operator<(const Service& other) const {
+        SORT_BENCH_COUNT(comparisons);
         if (cost != other.cost) {
             return cost < other.cost;
         }
@@ -90,6 +475,7 @@ struct Service {
       * @return True, если услуги считаются равными по критериям сортировки.
       */
     bool operator==(const Service& other) const {
+        SORT_BENCH_COUNT(comparisons);
         return cost == other.cost && prepayment == other.prepayment && name == other.name;
     }
 
@@ -104,6 +490,147 @@ struct Service {
 };
 
 
+/**
+ * @brief Облегченное представление IT-услуги, название которой хранится как ссылка на внешний буфер.
+ *
+ * Используется быстрым загрузчиком: поле name указывает прямо в отображенный в память файл,
+ * поэтому объект ServiceView действителен, только пока жив буфер (MappedFile), из которого он прочитан.
+ * Порядок сравнения совпадает с Service: стоимость, предоплата, название.
+ */
+struct ServiceView {
+    std::string_view name;  ///< Название услуги (ссылка на внешний буфер)
+    double cost;            ///< Ориентировочная стоимость
+    int duration;           ///< Срок исполнения (дни)
+    double prepayment;      ///< Размер предоплаты
+
+    /**
+     * @brief Конструктор по умолчанию.
+     */
+    ServiceView() : cost(0.0), duration(0), prepayment(0.0) {}
+
+    /**
+     * @brief Оператор "меньше" (<). Сравнивает так же, как Service::operator<.
+     * @param other Услуга, с которой производится сравнение.
+     * @return True, если текущая услуга "меньше" другой, иначе false.
+     */
+    bool operator<(const ServiceView& other) const {
+        if (cost != other.cost) {
+            return cost < other.cost;
+        }
+        if (prepayment != other.prepayment) {
+            return prepayment < other.prepayment;
+        }
+        return name < other.name;
+    }
+
+    /**
+     * @brief Оператор "больше" (>).
+     * @param other Услуга, с которой производится сравнение.
+     * @return True, если текущая услуга "больше" другой, иначе false.
+     */
+    bool operator>(const ServiceView& other) const {
+        return other < *this;
+    }
+};
+
+
+/**
+ * @brief Файл, отображенный в память только для чтения.
+ *
+ * На Windows использует CreateFileMapping/MapViewOfFile, на остальных платформах - mmap.
+ * Отображение освобождается в деструкторе; копирование запрещено.
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Открывает файл и отображает его в память целиком.
+     * @param filename Путь к файлу.
+     * @throws std::runtime_error Если файл не удается открыть или отобразить.
+     */
+    explicit MappedFile(const std::string& filename) {
+#ifdef _WIN32
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Ошибка: Не удалось открыть входной файл: " + filename);
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw std::runtime_error("Ошибка: Не удалось определить размер файла: " + filename);
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (bytes == nullptr) {
+            if (mapping != nullptr) CloseHandle(mapping);
+            CloseHandle(file);
+            throw std::runtime_error("Ошибка: Не удалось отобразить файл в память: " + filename);
+        }
+#else
+        descriptor = open(filename.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error("Ошибка: Не удалось открыть входной файл: " + filename);
+        }
+        struct stat fileStat;
+        if (fstat(descriptor, &fileStat) != 0) {
+            close(descriptor);
+            throw std::runtime_error("Ошибка: Не удалось определить размер файла: " + filename);
+        }
+        length = static_cast<size_t>(fileStat.st_size);
+        if (length == 0) return;
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address == MAP_FAILED) {
+            close(descriptor);
+            throw std::runtime_error("Ошибка: Не удалось отобразить файл в память: " + filename);
+        }
+        madvise(address, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*>(address);
+#endif
+    }
+
+    /**
+     * @brief Снимает отображение и закрывает файл.
+     */
+    ~MappedFile() {
+#ifdef _WIN32
+        if (bytes != nullptr) UnmapViewOfFile(bytes);
+        if (mapping != nullptr) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (bytes != nullptr) munmap(const_cast<char*>(bytes), length);
+        if (descriptor >= 0) close(descriptor);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Возвращает указатель на начало содержимого файла (nullptr для пустого файла).
+     */
+    const char* data() const { return bytes; }
+
+    /**
+     * @brief Возвращает размер файла в байтах.
+     */
+    size_t size() const { return length; }
+
+private:
+    const char* bytes = nullptr;    ///< Начало отображенной области
+    size_t length = 0;              ///< Размер файла в байтах
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int descriptor = -1;
+#endif
+};
+
+
 /**
  * @brief Перегружает оператор ввода (>>) для чтения объекта Service из потока.
  * Ожидает формат CSV: Название,Стоимость,Срок,Предоплата
@@ -189,141 +716,7035 @@ bool loadServices(const std::string& filename, std::vector<Service>& services) {
 
 
 /**
- * @brief Сохраняет данные об услугах в CSV-файл.
- * @param filename Путь к выходному CSV-файлу.
- * @param services Вектор, содержащий объекты Service для сохранения.
- * @return True, если сохранение прошло успешно, иначе false.
- * @throws std::runtime_error Если файл не удается открыть для записи.
+ * @brief Разбирает числовое поле CSV с помощью std::from_chars и переходит к следующему полю.
+ * При ошибке разбора значение обнуляется, как и в operator>>.
+ * @tparam T Тип значения (double или int).
+ * @param first Начало поля.
+ * @param last Конец строки.
+ * @param value Переменная для записи результата.
+ * @return Указатель на начало следующего поля (или last, если полей больше нет).
  */
-bool saveServices(const std::string& filename, const std::vector<Service>& services) {
-    std::ofstream outFile(filename);
-    if (!outFile.is_open()) {
-        throw std::runtime_error("Ошибка: Не удалось открыть выходной файл для записи: " + filename);
+template<typename T>
+const char* parseCsvNumber(const char* first, const char* last, T& value) {
+    auto result = std::from_chars(first, last, value);
+    if (result.ec != std::errc()) {
+        value = T();
     }
+    const char* comma = static_cast<const char*>(std::memchr(result.ptr, ',', last - result.ptr));
+    return comma ? comma + 1 : last;
+}
 
-    outFile << "Название услуги,Ориентировочная стоимость,Срок исполнения (дни),Размер предоплаты\n";
 
-    for (const auto& service : services) {
-        outFile << service << "\n";
+/**
+ * @brief Разбирает строки CSV из буфера за один проход и добавляет их в вектор.
+ * Заголовок не пропускается - буфер должен начинаться с первой строки данных.
+ * Пустые строки игнорируются, завершающий '\r' отбрасывается.
+ * @param first Начало буфера.
+ * @param last Конец буфера.
+ * @param services Вектор, в конец которого добавляются записи (названия ссылаются на буфер).
+ */
+void parseServicesBuffer(const char* first, const char* last, std::vector<ServiceView>& services) {
+    const char* p = first;
+    while (p < last) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', last - p));
+        if (lineEnd == nullptr) lineEnd = last;
+        const char* rowEnd = lineEnd;
+        if (rowEnd > p && rowEnd[-1] == '\r') --rowEnd;
+
+        if (rowEnd > p) {
+            ServiceView s;
+            const char* comma = static_cast<const char*>(std::memchr(p, ',', rowEnd - p));
+            if (comma == nullptr) comma = rowEnd;
+            s.name = std::string_view(p, comma - p);
+            const char* field = comma < rowEnd ? comma + 1 : rowEnd;
+            field = parseCsvNumber(field, rowEnd, s.cost);
+            field = parseCsvNumber(field, rowEnd, s.duration);
+            parseCsvNumber(field, rowEnd, s.prepayment);
+            services.push_back(s);
+        }
+        p = lineEnd + 1;
     }
+}
 
-    if (outFile.bad()) {
-        std::cerr << "Ошибка записи в файл: " << filename << std::endl;
-        outFile.close();
+
+/**
+ * @brief Быстро загружает данные об услугах из отображенного в память CSV-файла.
+ * В отличие от loadServices, не создает std::string и std::stringstream на каждую строку:
+ * названия услуг остаются ссылками на содержимое file.
+ * @param file Отображенный в память CSV-файл (должен жить дольше, чем services).
+ * @param services Вектор для сохранения загруженных записей (будет очищен перед загрузкой).
+ * @return True, если прочитан заголовок и есть данные, иначе false.
+ */
+bool loadServicesMapped(const MappedFile& file, std::vector<ServiceView>& services) {
+    services.clear();
+    const char* first = file.data();
+    const char* last = first + file.size();
+
+    const char* headerEnd = file.size() ? static_cast<const char*>(std::memchr(first, '\n', file.size())) : nullptr;
+    if (headerEnd == nullptr) {
+        std::cerr << "Предупреждение: Не удалось прочитать заголовок или файл пуст." << std::endl;
         return false;
     }
 
-    outFile.close();
+    services.reserve(static_cast<size_t>(std::count(headerEnd + 1, last, '\n')) + 1);
+    parseServicesBuffer(headerEnd + 1, last, services);
+
+    if (services.empty()) {
+        std::cerr << "Предупреждение: Файл содержит только заголовок или данные некорректны." << std::endl;
+        return false;
+    }
     return true;
 }
 
 
 /**
- * @brief Сортирует вектор объектов Service методом пузырька.
- * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @brief Параллельно загружает данные об услугах из отображенного в память CSV-файла.
+ * Буфер после заголовка делится на threadCount частей по границам строк, каждая часть
+ * разбирается в собственном потоке в отдельный вектор, после чего результаты
+ * объединяются в исходном порядке строк.
+ * @param file Отображенный в память CSV-файл (должен жить дольше, чем services).
+ * @param services Вектор для сохранения загруженных записей (будет очищен перед загрузкой).
+ * @param threadCount Количество потоков (0 - по числу аппаратных потоков).
+ * @return True, если прочитан заголовок и есть данные, иначе false.
  */
-void bubbleSort(std::vector<Service>& arr) {
-    int n = arr.size();
-    for (int i = 0; i < n - 1; ++i) {
-        for (int j = 0; j < n - i - 1; ++j) {
-            if (arr[j] > arr[j + 1]) {
-                std::swap(arr[j], arr[j + 1]);
-            }
-        }
+bool loadServicesParallel(const MappedFile& file, std::vector<ServiceView>& services, unsigned threadCount) {
+    services.clear();
+    const char* first = file.data();
+    const char* last = first + file.size();
+
+    const char* headerEnd = file.size() ? static_cast<const char*>(std::memchr(first, '\n', file.size())) : nullptr;
+    if (headerEnd == nullptr) {
+        std::cerr << "Предупреждение: Не удалось прочитать заголовок или файл пуст." << std::endl;
+        return false;
+    }
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const char* body = headerEnd + 1;
+    size_t bodySize = static_cast<size_t>(last - body);
+    std::vector<const char*> bounds;
+    bounds.push_back(body);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        const char* cut = body + bodySize * i / threadCount;
+        if (cut < bounds.back()) cut = bounds.back();
+        const char* lineEnd = static_cast<const char*>(std::memchr(cut, '\n', last - cut));
+        cut = lineEnd ? lineEnd + 1 : last;
+        bounds.push_back(cut);
+    }
+    bounds.push_back(last);
+
+    std::vector<std::vector<ServiceView>> parts(threadCount);
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([&parts, &bounds, i]() {
+            parts[i].reserve(static_cast<size_t>(std::count(bounds[i], bounds[i + 1], '\n')) + 1);
+            parseServicesBuffer(bounds[i], bounds[i + 1], parts[i]);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    services.reserve(total);
+    for (const auto& part : parts) {
+        services.insert(services.end(), part.begin(), part.end());
     }
+
+    if (services.empty()) {
+        std::cerr << "Предупреждение: Файл содержит только заголовок или данные некорректны." << std::endl;
+        return false;
+    }
+    return true;
 }
 
 
 /**
- * @brief Сортирует вектор объектов Service методом вставок.
- * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @brief Читает CSV-файл блоками фиксированного размера и передает каждую запись обработчику.
+ * Весь файл в память не загружается: в каждый момент хранится один блок и незавершенная строка.
+ * Названия в ServiceView ссылаются на внутренний буфер и действительны только во время вызова visit.
+ * @tparam Visit Тип обработчика, вызываемого как visit(const ServiceView&).
+ * @param filename Путь к CSV-файлу.
+ * @param blockBytes Размер блока чтения.
+ * @param visit Обработчик записей.
+ * @return True, если прочитан заголовок и не было ошибок чтения, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть.
  */
-void insertionSort(std::vector<Service>& arr) {
-    int n = arr.size();
-    for (int i = 1; i < n; ++i) {
-        Service key = arr[i];
-        int j = i - 1;
-        while (j >= 0 && arr[j] > key) {
-            arr[j + 1] = arr[j];
-            j = j - 1;
+template<typename Visit>
+bool streamServices(const std::string& filename, size_t blockBytes, Visit visit) {
+    std::ifstream inFile(filename, std::ios::binary);
+    if (!inFile.is_open()) {
+        throw std::runtime_error("Ошибка: Не удалось открыть входной файл: " + filename);
+    }
+    std::string header;
+    if (!std::getline(inFile, header)) {
+        std::cerr << "Предупреждение: Не удалось прочитать заголовок или файл пуст: " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<char> block(std::max<size_t>(blockBytes, 1));
+    std::vector<char> pending;
+    std::vector<ServiceView> views;
+    while (inFile) {
+        inFile.read(block.data(), static_cast<std::streamsize>(block.size()));
+        size_t got = static_cast<size_t>(inFile.gcount());
+        if (got == 0) break;
+        pending.insert(pending.end(), block.begin(), block.begin() + got);
+        size_t complete = pending.size();
+        if (inFile) {
+            while (complete > 0 && pending[complete - 1] != '\n') --complete;
+        }
+        views.clear();
+        parseServicesBuffer(pending.data(), pending.data() + complete, views);
+        for (const auto& view : views) {
+            visit(view);
+        }
+        pending.erase(pending.begin(), pending.begin() + complete);
+    }
+    if (inFile.bad()) {
+        std::cerr << "Ошибка чтения данных из файла: " << filename << std::endl;
+        return false;
+    }
+    // Последняя строка без '\n', если данные после заголовка кратны размеру блока: последнее полное
+    // чтение оставило поток в порядке, ее хвост был отложен, а следующее чтение вернуло 0 байт.
+    if (!pending.empty()) {
+        views.clear();
+        parseServicesBuffer(pending.data(), pending.data() + pending.size(), views);
+        for (const auto& view : views) {
+            visit(view);
         }
-        arr[j + 1] = key;
     }
+    return true;
 }
 
 
 /**
- * @brief Сортирует вектор объектов Service методом Шейкера (двунаправленная пузырьковая).
- * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @brief Набор услуг, названия которых хранятся в одной непрерывной арене.
+ *
+ * Записи - это ServiceView, ссылающиеся на арену, поэтому каждая запись тривиально копируема
+ * и не владеет памятью. Арена разделяется между копиями набора через std::shared_ptr:
+ * копирование набора для очередного запуска сортировки сводится к копированию плоского
+ * массива записей без выделения памяти под каждую строку.
+ */
+struct PooledServices {
+    std::shared_ptr<const std::string> arena;   ///< Непрерывный буфер со всеми названиями
+    std::vector<ServiceView> records;           ///< Записи, названия которых указывают в arena
+
+    /**
+     * @brief Строит набор из записей, копируя их названия в новую арену.
+     * @param views Исходные записи (их названия могут ссылаться на любой буфер).
+     */
+    static PooledServices fromViews(const std::vector<ServiceView>& views) {
+        size_t poolBytes = 0;
+        for (const auto& view : views) poolBytes += view.name.size();
+        auto names = std::make_shared<std::string>();
+        names->reserve(poolBytes);
+        for (const auto& view : views) names->append(view.name.data(), view.name.size());
+
+        PooledServices dataset;
+        dataset.records = views;
+        size_t offset = 0;
+        for (auto& record : dataset.records) {
+            size_t length = record.name.size();
+            record.name = std::string_view(names->data() + offset, length);
+            offset += length;
+        }
+        dataset.arena = std::move(names);
+        return dataset;
+    }
+
+    /**
+     * @brief Строит набор из вектора Service.
+     */
+    static PooledServices fromServices(const std::vector<Service>& services) {
+        std::vector<ServiceView> views(services.size());
+        for (size_t i = 0; i < services.size(); ++i) {
+            views[i].name = services[i].name;
+            views[i].cost = services[i].cost;
+            views[i].duration = services[i].duration;
+            views[i].prepayment = services[i].prepayment;
+        }
+        return fromViews(views);
+    }
+
+    /**
+     * @brief Преобразует набор обратно в вектор Service.
+     */
+    std::vector<Service> toServices() const {
+        std::vector<Service> services;
+        services.reserve(records.size());
+        for (const auto& record : records) {
+            services.emplace_back(std::string(record.name), record.cost, record.duration, record.prepayment);
+        }
+        return services;
+    }
+};
+
+
+/**
+ * @brief Загружает данные об услугах из CSV-файла в набор с ареной названий.
+ * Файл отображается в память и разбирается быстрым загрузчиком; названия копируются в арену
+ * одним выделением памяти, после чего отображение файла закрывается.
+ * @param filename Путь к CSV-файлу.
+ * @param dataset Набор для сохранения загруженных записей (будет заменен).
+ * @return True, если прочитан заголовок и есть данные, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть.
+ */
+bool loadServicesPooled(const std::string& filename, PooledServices& dataset) {
+    dataset = PooledServices();
+    MappedFile file(filename);
+    std::vector<ServiceView> views;
+    if (!loadServicesMapped(file, views)) {
+        std::cerr << "Предупреждение: Не удалось загрузить данные в арену из файла: " << filename << std::endl;
+        return false;
+    }
+    dataset = PooledServices::fromViews(views);
+    return true;
+}
+
+
+/**
+ * @brief Вычисляет 64-битную контрольную сумму буфера (FNV-1a по 64-битным словам).
+ * @param data Начало буфера.
+ * @param size Размер буфера в байтах.
+ * @return Контрольная сумма.
+ */
+uint64_t checksum64(const char* data, size_t size) {
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
+
+
+/**
+ * @brief Возвращает отметку времени последнего изменения файла (тики file_time_type).
+ * @param filename Путь к файлу.
+ * @return Отметка времени или 0, если ее не удается получить.
+ */
+uint64_t fileModificationStamp(const std::string& filename) {
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(filename, error);
+    return error ? 0 : static_cast<uint64_t>(modified.time_since_epoch().count());
+}
+
+
+/**
+ * @brief Заголовок бинарного столбцового файла набора данных (.svcb).
+ *
+ * После заголовка следуют столбцы: cost[n] (double), prepayment[n] (double), duration[n] (int32),
+ * таблица смещений названий nameOffsets[n + 1] (uint64) и блок названий. Каждый столбец
+ * выровнен на 8 байт. Порядок байт - родной для машины, он проверяется по полю byteOrder.
+ */
+struct BinaryDatasetHeader {
+    char magic[8];              ///< Сигнатура "SVCBIN\0\0"
+    uint32_t version;           ///< Версия формата
+    uint32_t byteOrder;         ///< 0x01020304 в порядке байт записавшей машины
+    uint64_t recordCount;       ///< Количество записей
+    uint64_t namePoolBytes;     ///< Размер блока названий в байтах
+    uint64_t sourceSize;        ///< Размер исходного CSV-файла
+    uint64_t sourceModified;    ///< fileModificationStamp исходного CSV-файла на момент конвертации
+    uint64_t payloadChecksum;   ///< checksum64 всех данных после заголовка
+    uint64_t reserved;          ///< Зарезервировано (0)
+};
+static_assert(sizeof(BinaryDatasetHeader) == 64, "Заголовок бинарного файла должен занимать 64 байта");
+
+const char BINARY_DATASET_MAGIC[8] = {'S', 'V', 'C', 'B', 'I', 'N', '\0', '\0'};
+const uint32_t BINARY_DATASET_VERSION = 3;
+const uint32_t BINARY_DATASET_BYTE_ORDER = 0x01020304;
+
+
+/**
+ * @brief Смещения столбцов бинарного файла относительно его начала.
+ */
+struct BinaryDatasetLayout {
+    size_t cost;            ///< Начало столбца cost
+    size_t prepayment;      ///< Начало столбца prepayment
+    size_t duration;        ///< Начало столбца duration
+    size_t nameOffsets;     ///< Начало таблицы смещений названий
+    size_t names;           ///< Начало блока названий
+    size_t total;           ///< Полный размер файла
+
+    /**
+     * @brief Вычисляет раскладку для заданного количества записей и размера блока названий.
+     */
+    static BinaryDatasetLayout compute(size_t records, size_t namePoolBytes) {
+        auto align8 = [](size_t value) { return (value + 7) & ~static_cast<size_t>(7); };
+        BinaryDatasetLayout layout;
+        layout.cost = sizeof(BinaryDatasetHeader);
+        layout.prepayment = layout.cost + records * sizeof(double);
+        layout.duration = layout.prepayment + records * sizeof(double);
+        layout.nameOffsets = align8(layout.duration + records * sizeof(int32_t));
+        layout.names = align8(layout.nameOffsets + (records + 1) * sizeof(uint64_t));
+        layout.total = layout.names + namePoolBytes;
+        return layout;
+    }
+};
+
+
+/**
+ * @brief Записывает набор услуг в бинарный столбцовый файл.
+ * @param filename Путь к выходному файлу.
+ * @param services Записи для сохранения.
+ * @param sourceSize Размер исходного CSV-файла.
+ * @param sourceModified Отметка времени изменения исходного CSV-файла (fileModificationStamp).
+ * @return True, если запись прошла успешно, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть для записи.
+ */
+bool saveServicesBinary(const std::string& filename, const std::vector<ServiceView>& services,
+                        uint64_t sourceSize, uint64_t sourceModified) {
+    size_t n = services.size();
+    size_t namePoolBytes = 0;
+    for (const auto& service : services) namePoolBytes += service.name.size();
+    BinaryDatasetLayout layout = BinaryDatasetLayout::compute(n, namePoolBytes);
+
+    std::vector<char> image(layout.total, 0);
+    uint64_t nameOffset = 0;   // 64 бита: блок названий может превышать 4 ГиБ
+    for (size_t i = 0; i < n; ++i) {
+        const ServiceView& service = services[i];
+        int32_t duration = service.duration;
+        std::memcpy(&image[layout.cost + i * sizeof(double)], &service.cost, sizeof(double));
+        std::memcpy(&image[layout.prepayment + i * sizeof(double)], &service.prepayment, sizeof(double));
+        std::memcpy(&image[layout.duration + i * sizeof(int32_t)], &duration, sizeof(int32_t));
+        std::memcpy(&image[layout.nameOffsets + i * sizeof(uint64_t)], &nameOffset, sizeof(uint64_t));
+        std::memcpy(&image[layout.names + nameOffset], service.name.data(), service.name.size());
+        nameOffset += service.name.size();
+    }
+    std::memcpy(&image[layout.nameOffsets + n * sizeof(uint64_t)], &nameOffset, sizeof(uint64_t));
+
+    BinaryDatasetHeader header;
+    std::memcpy(header.magic, BINARY_DATASET_MAGIC, sizeof(header.magic));
+    header.version = BINARY_DATASET_VERSION;
+    header.byteOrder = BINARY_DATASET_BYTE_ORDER;
+    header.recordCount = n;
+    header.namePoolBytes = namePoolBytes;
+    header.sourceSize = sourceSize;
+    header.sourceModified = sourceModified;
+    header.payloadChecksum = checksum64(image.data() + sizeof(header), image.size() - sizeof(header));
+    header.reserved = 0;
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    std::ofstream outFile(filename, std::ios::binary);
+    if (!outFile.is_open()) {
+        throw std::runtime_error("Ошибка: Не удалось открыть выходной файл для записи: " + filename);
+    }
+    outFile.write(image.data(), static_cast<std::streamsize>(image.size()));
+    if (outFile.bad()) {
+        std::cerr << "Ошибка записи в файл: " << filename << std::endl;
+        outFile.close();
+        return false;
+    }
+    outFile.close();
+    return true;
+}
+
+
+/**
+ * @brief Конвертирует CSV-файл набора данных в бинарный столбцовый формат.
+ * @param csvFilename Путь к исходному CSV-файлу.
+ * @param binaryFilename Путь к выходному бинарному файлу.
+ * @return True, если конвертация прошла успешно, иначе false.
+ * @throws std::runtime_error Если один из файлов не удается открыть.
+ */
+bool convertCsvToBinary(const std::string& csvFilename, const std::string& binaryFilename) {
+    // Отметка берется до чтения: если CSV изменится во время конвертации, бинарный файл окажется устаревшим.
+    uint64_t sourceModified = fileModificationStamp(csvFilename);
+    MappedFile csv(csvFilename);
+    std::vector<ServiceView> views;
+    if (!loadServicesMapped(csv, views)) {
+        return false;
+    }
+    return saveServicesBinary(binaryFilename, views, csv.size(), sourceModified);
+}
+
+
+/**
+ * @brief Бинарный столбцовый набор данных, отображенный в память.
+ *
+ * Столбцы читаются прямо из отображения без разбора; названия возвращаются как ссылки на него.
+ * Перед использованием следует проверить isValid().
+ */
+class BinaryDataset {
+public:
+    /**
+     * @brief Отображает файл в память и проверяет заголовок, размер и контрольную сумму.
+     * @param filename Путь к бинарному файлу.
+     * @throws std::runtime_error Если файл не удается открыть.
+     */
+    explicit BinaryDataset(const std::string& filename) : file(filename) {
+        if (file.size() < sizeof(BinaryDatasetHeader)) return;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::memcmp(header.magic, BINARY_DATASET_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != BINARY_DATASET_VERSION || header.byteOrder != BINARY_DATASET_BYTE_ORDER) {
+            return;
+        }
+        layout = BinaryDatasetLayout::compute(header.recordCount, header.namePoolBytes);
+        if (layout.total != file.size()) return;
+        if (checksum64(file.data() + sizeof(header), file.size() - sizeof(header)) != header.payloadChecksum) return;
+        valid = true;
+    }
+
+    /**
+     * @brief Возвращает true, если файл имеет корректный формат и контрольная сумма совпала.
+     */
+    bool isValid() const { return valid; }
+
+    /**
+     * @brief Возвращает заголовок файла.
+     */
+    const BinaryDatasetHeader& getHeader() const { return header; }
+
+    /**
+     * @brief Возвращает количество записей.
+     */
+    size_t size() const { return valid ? static_cast<size_t>(header.recordCount) : 0; }
+
+    /**
+     * @brief Возвращает столбец стоимостей.
+     */
+    const double* cost() const { return reinterpret_cast<const double*>(file.data() + layout.cost); }
+
+    /**
+     * @brief Возвращает столбец предоплат.
+     */
+    const double* prepayment() const { return reinterpret_cast<const double*>(file.data() + layout.prepayment); }
+
+    /**
+     * @brief Возвращает столбец сроков исполнения.
+     */
+    const int32_t* duration() const { return reinterpret_cast<const int32_t*>(file.data() + layout.duration); }
+
+    /**
+     * @brief Возвращает название записи i как ссылку на отображение.
+     */
+    std::string_view name(size_t i) const {
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(file.data() + layout.nameOffsets);
+        return std::string_view(file.data() + layout.names + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    /**
+     * @brief Заполняет вектор ServiceView, ссылающихся на отображение (действительны, пока жив объект).
+     */
+    void toViews(std::vector<ServiceView>& views) const {
+        views.resize(size());
+        const double* costs = cost();
+        const double* prepayments = prepayment();
+        const int32_t* durations = duration();
+        for (size_t i = 0; i < views.size(); ++i) {
+            views[i].name = name(i);
+            views[i].cost = costs[i];
+            views[i].duration = durations[i];
+            views[i].prepayment = prepayments[i];
+        }
+    }
+
+private:
+    MappedFile file;
+    BinaryDatasetHeader header{};
+    BinaryDatasetLayout layout{};
+    bool valid = false;
+};
+
+
+/**
+ * @brief Загружает данные об услугах из бинарного файла, если он корректен и соответствует CSV-файлу.
+ * Бинарный файл считается соответствующим, если размер и время изменения CSV-файла совпадают
+ * с записанными в заголовке; сам CSV-файл не читается (если его нет, проверяется только бинарный файл).
+ * @param binaryFilename Путь к бинарному файлу.
+ * @param csvFilename Путь к исходному CSV-файлу.
+ * @param services Вектор для сохранения загруженных объектов Service (будет очищен перед загрузкой).
+ * @return True, если данные загружены из бинарного файла; false, если его нужно пересоздать из CSV.
+ */
+bool loadServicesBinary(const std::string& binaryFilename, const std::string& csvFilename, std::vector<Service>& services) {
+    services.clear();
+    try {
+        BinaryDataset dataset(binaryFilename);
+        if (!dataset.isValid() || dataset.size() == 0) {
+            std::cerr << "Предупреждение: Бинарный файл '" << binaryFilename << "' поврежден или имеет неверный формат." << std::endl;
+            return false;
+        }
+        std::error_code error;
+        uintmax_t csvSize = std::filesystem::file_size(csvFilename, error);
+        // Без CSV-файла бинарный файл используется как единственный источник.
+        if (!error && (csvSize != dataset.getHeader().sourceSize ||
+                       fileModificationStamp(csvFilename) != dataset.getHeader().sourceModified)) {
+            std::cerr << "Предупреждение: Бинарный файл '" << binaryFilename << "' устарел относительно " << csvFilename << "." << std::endl;
+            return false;
+        }
+
+        // Записи заполняются на месте из столбцов, без временных строк и перемещений.
+        services.resize(dataset.size());
+        const double* costs = dataset.cost();
+        const double* prepayments = dataset.prepayment();
+        const int32_t* durations = dataset.duration();
+        for (size_t i = 0; i < services.size(); ++i) {
+            Service& service = services[i];
+            std::string_view name = dataset.name(i);
+            service.name.assign(name.data(), name.size());
+            service.cost = costs[i];
+            service.duration = durations[i];
+            service.prepayment = prepayments[i];
+        }
+        return true;
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+}
+
+
+/**
+ * @brief Сохраняет данные об услугах в CSV-файл.
+ * @param filename Путь к выходному CSV-файлу.
+ * @param services Вектор, содержащий объекты Service для сохранения.
+ * @return True, если сохранение прошло успешно, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть для записи.
+ */
+bool saveServices(const std::string& filename, const std::vector<Service>& services) {
+    std::ofstream outFile(filename);
+    if (!outFile.is_open()) {
+        throw std::runtime_error("Ошибка: Не удалось открыть выходной файл для записи: " + filename);
+    }
+
+    outFile << "Название услуги,Ориентировочная стоимость,Срок исполнения (дни),Размер предоплаты\n";
+
+    for (const auto& service : services) {
+        outFile << service << "\n";
+    }
+
+    if (outFile.bad()) {
+        std::cerr << "Ошибка записи в файл: " << filename << std::endl;
+        outFile.close();
+        return false;
+    }
+
+    outFile.close();
+    return true;
+}
+
+
+/**
+ * @brief Буферизованная запись CSV крупными блоками с форматированием чисел через std::to_chars.
+ *
+ * Текст накапливается в буфере и сбрасывается в файл блоками по blockBytes байт. В фоновом
+ * режиме заполненный буфер передается отдельному потоку записи (двойная буферизация),
+ * и форматирование следующего блока идет параллельно с вводом-выводом. Файл открывается
+ * в текстовом режиме, как и в saveServices, поэтому вывод совпадает с ним побайтно.
+ */
+class CsvBlockWriter {
+public:
+    /**
+     * @brief Открывает файл для записи.
+     * @param filename Путь к выходному файлу.
+     * @param backgroundWrite Выполнять запись на диск в фоновом потоке.
+     * @param blockBytes Размер блока записи.
+     * @throws std::runtime_error Если файл не удается открыть.
+     */
+    CsvBlockWriter(const std::string& filename, bool backgroundWrite, size_t blockBytes = 1u << 20)
+        : out(filename), blockSize(std::max<size_t>(blockBytes, 4096)) {
+        if (!out.is_open()) {
+            throw std::runtime_error("Ошибка: Не удалось открыть выходной файл для записи: " + filename);
+        }
+        current.resize(blockSize + RECORD_SLACK);
+        if (backgroundWrite) {
+            spare.resize(blockSize + RECORD_SLACK);
+            writer = std::thread([this]() { writerLoop(); });
+        }
+    }
+
+    ~CsvBlockWriter() {
+        close();
+    }
+
+    CsvBlockWriter(const CsvBlockWriter&) = delete;
+    CsvBlockWriter& operator=(const CsvBlockWriter&) = delete;
+
+    /**
+     * @brief Добавляет произвольный текст.
+     */
+    void write(std::string_view text) {
+        while (!text.empty()) {
+            size_t chunk = std::min(text.size(), blockSize - std::min(used, blockSize));
+            if (chunk == 0) {
+                submit();
+                continue;
+            }
+            std::memcpy(current.data() + used, text.data(), chunk);
+            used += chunk;
+            text.remove_prefix(chunk);
+        }
+    }
+
+    /**
+     * @brief Добавляет строку CSV с записью в формате saveServices (числа с двумя знаками после запятой).
+     */
+    void writeService(std::string_view name, double cost, int duration, double prepayment) {
+        if (name.size() + RECORD_SLACK > current.size() - used) {
+            write(name);
+        } else {
+            std::memcpy(current.data() + used, name.data(), name.size());
+            used += name.size();
+        }
+        char* first = current.data() + used;
+        char* last = current.data() + current.size();
+        char* p = first;
+        *p++ = ',';
+        p = std::to_chars(p, last, cost, std::chars_format::fixed, 2).ptr;
+        *p++ = ',';
+        p = std::to_chars(p, last, duration).ptr;
+        *p++ = ',';
+        p = std::to_chars(p, last, prepayment, std::chars_format::fixed, 2).ptr;
+        *p++ = '\n';
+        used += p - first;
+        if (used >= blockSize) submit();
+    }
+
+    /**
+     * @brief Сбрасывает оставшиеся данные и закрывает файл.
+     * @return True, если все данные записаны без ошибок.
+     */
+    bool close() {
+        if (closed) return !failed;
+        submit();
+        if (writer.joinable()) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                idle.wait(lock, [this]() { return !hasWork; });
+                stopping = true;
+            }
+            ready.notify_one();
+            writer.join();
+        }
+        out.close();
+        if (out.fail()) failed = true;
+        closed = true;
+        return !failed;
+    }
+
+private:
+    /// Запас в конце буфера, достаточный для чисел и разделителей одной записи.
+    static constexpr size_t RECORD_SLACK = 1024;
+
+    void submit() {
+        if (used == 0) return;
+        if (!writer.joinable()) {
+            out.write(current.data(), static_cast<std::streamsize>(used));
+            if (out.bad()) failed = true;
+            used = 0;
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return !hasWork; });
+        current.swap(spare);
+        spareUsed = used;
+        used = 0;
+        hasWork = true;
+        lock.unlock();
+        ready.notify_one();
+    }
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            ready.wait(lock, [this]() { return hasWork || stopping; });
+            if (!hasWork && stopping) break;
+            lock.unlock();
+            out.write(spare.data(), static_cast<std::streamsize>(spareUsed));
+            bool writeFailed = out.bad();
+            lock.lock();
+            if (writeFailed) failed = true;
+            hasWork = false;
+            idle.notify_one();
+        }
+    }
+
+    std::ofstream out;
+    size_t blockSize;
+    std::vector<char> current;
+    size_t used = 0;
+    std::vector<char> spare;
+    size_t spareUsed = 0;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable idle;
+    bool hasWork = false;
+    bool stopping = false;
+    bool failed = false;
+    bool closed = false;
+};
+
+
+/**
+ * @brief Быстро сохраняет данные об услугах в CSV-файл (вывод побайтно совпадает с saveServices).
+ * Числа форматируются std::to_chars в большой буфер, который сбрасывается на диск крупными блоками.
+ * @param filename Путь к выходному CSV-файлу.
+ * @param services Вектор, содержащий объекты Service для сохранения.
+ * @param backgroundWrite Выполнять запись на диск в фоновом потоке, параллельно с форматированием.
+ * @return True, если сохранение прошло успешно, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть для записи.
+ */
+bool saveServicesFast(const std::string& filename, const std::vector<Service>& services, bool backgroundWrite = false) {
+    CsvBlockWriter writer(filename, backgroundWrite);
+    writer.write("Название услуги,Ориентировочная стоимость,Срок исполнения (дни),Размер предоплаты\n");
+    for (const auto& service : services) {
+        writer.writeService(service.name, service.cost, service.duration, service.prepayment);
+    }
+    if (!writer.close()) {
+        std::cerr << "Ошибка записи в файл: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Параметры внешней (out-of-core) сортировки.
+ */
+struct ExternalSortConfig {
+    size_t memoryBudgetBytes = 256u << 20;  ///< Бюджет памяти на сортируемую порцию записей
+    std::string tempDirectory;              ///< Каталог для временных файлов (пусто - системный временный каталог)
+    size_t readBlockBytes = 1u << 20;       ///< Размер блока чтения входного CSV и временных файлов
+    size_t maxMergeFanIn = 128;             ///< Максимальное количество серий, сливаемых за один проход
+};
+
+
+/**
+ * @brief Статистика выполнения внешней сортировки.
+ */
+struct ExternalSortStats {
+    size_t records = 0;         ///< Количество отсортированных записей
+    size_t runs = 0;            ///< Количество начальных отсортированных серий
+    size_t mergePasses = 0;     ///< Количество проходов слияния
+    double runPhaseMs = 0.0;    ///< Время чтения, сортировки порций и записи серий (мс)
+    double mergePhaseMs = 0.0;  ///< Время слияния серий и записи результата (мс)
+};
+
+
+/**
+ * @brief Записывает запись Service во временный файл серии в компактном двоичном виде.
+ * Формат: cost (double), prepayment (double), duration (int32), длина названия (uint32), название.
+ * @param buffer Буфер, в конец которого дописывается запись.
+ * @param service Запись.
+ */
+void appendRunRecord(std::string& buffer, const Service& service) {
+    int32_t duration = service.duration;
+    uint32_t length = static_cast<uint32_t>(service.name.size());
+    buffer.append(reinterpret_cast<const char*>(&service.cost), sizeof(double));
+    buffer.append(reinterpret_cast<const char*>(&service.prepayment), sizeof(double));
+    buffer.append(reinterpret_cast<const char*>(&duration), sizeof(int32_t));
+    buffer.append(reinterpret_cast<const char*>(&length), sizeof(uint32_t));
+    buffer.append(service.name);
+}
+
+
+/**
+ * @brief Последовательная запись серии во временный файл крупными блоками.
+ */
+class RunWriter {
+public:
+    /**
+     * @brief Создает файл серии.
+     * @param path Путь к файлу.
+     * @param blockBytes Размер блока, по достижении которого буфер сбрасывается на диск.
+     * @throws std::runtime_error Если файл не удается создать.
+     */
+    RunWriter(const std::string& path, size_t blockBytes) : out(path, std::ios::binary), blockSize(blockBytes) {
+        if (!out.is_open()) {
+            throw std::runtime_error("Ошибка: Не удалось создать временный файл: " + path);
+        }
+        buffer.reserve(blockSize + 4096);
+    }
+
+    /**
+     * @brief Добавляет запись в серию.
+     */
+    void write(const Service& service) {
+        appendRunRecord(buffer, service);
+        if (buffer.size() >= blockSize) flush();
+    }
+
+    /**
+     * @brief Сбрасывает буфер и закрывает файл.
+     * @throws std::runtime_error При ошибке записи.
+     */
+    void close() {
+        flush();
+        out.close();
+        if (out.fail()) {
+            throw std::runtime_error("Ошибка записи временного файла внешней сортировки.");
+        }
+    }
+
+private:
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    std::ofstream out;
+    size_t blockSize;
+    std::string buffer;
+};
+
+
+/**
+ * @brief Последовательное чтение серии из временного файла с асинхронной предвыборкой блоков.
+ * Пока разбирается текущий блок, следующий блок читается в фоне (std::async).
+ */
+class RunReader {
+public:
+    /**
+     * @brief Открывает файл серии и запускает чтение первого блока.
+     * @param path Путь к файлу.
+     * @param blockBytes Размер блока чтения.
+     * @throws std::runtime_error Если файл не удается открыть.
+     */
+    RunReader(const std::string& path, size_t blockBytes) : in(path, std::ios::binary), blockSize(blockBytes) {
+        if (!in.is_open()) {
+            throw std::runtime_error("Ошибка: Не удалось открыть временный файл: " + path);
+        }
+        startPrefetch();
+    }
+
+    ~RunReader() {
+        if (pending.valid()) pending.wait();
+    }
+
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+
+    /**
+     * @brief Читает следующую запись серии.
+     * @param service Запись для заполнения.
+     * @return False, если серия закончилась.
+     */
+    bool next(Service& service) {
+        const size_t fixedBytes = 2 * sizeof(double) + sizeof(int32_t) + sizeof(uint32_t);
+        if (!ensure(fixedBytes)) return false;
+        int32_t duration;
+        uint32_t length;
+        std::memcpy(&service.cost, &current[position], sizeof(double));
+        std::memcpy(&service.prepayment, &current[position + 8], sizeof(double));
+        std::memcpy(&duration, &current[position + 16], sizeof(int32_t));
+        std::memcpy(&length, &current[position + 20], sizeof(uint32_t));
+        if (!ensure(fixedBytes + length)) {
+            throw std::runtime_error("Ошибка: Временный файл внешней сортировки поврежден.");
+        }
+        service.duration = duration;
+        service.name.assign(&current[position + fixedBytes], length);
+        position += fixedBytes + length;
+        return true;
+    }
+
+private:
+    void startPrefetch() {
+        pending = std::async(std::launch::async, [this]() {
+            prefetched.resize(blockSize);
+            in.read(prefetched.data(), static_cast<std::streamsize>(blockSize));
+            prefetched.resize(static_cast<size_t>(in.gcount()));
+            return !prefetched.empty();
+        });
+    }
+
+    bool ensure(size_t bytes) {
+        while (current.size() - position < bytes) {
+            if (finished) return false;
+            bool gotData = pending.get();
+            current.erase(current.begin(), current.begin() + position);
+            position = 0;
+            if (!gotData) {
+                finished = true;
+                return current.size() >= bytes;
+            }
+            current.insert(current.end(), prefetched.begin(), prefetched.end());
+            startPrefetch();
+        }
+        return true;
+    }
+
+    std::ifstream in;
+    size_t blockSize;
+    std::vector<char> current;
+    std::vector<char> prefetched;
+    size_t position = 0;
+    bool finished = false;
+    std::future<bool> pending;
+};
+
+
+/**
+ * @brief Дерево проигравших для k-путевого слияния серий.
+ *
+ * Во внутренних узлах хранятся индексы проигравших источников, в узле 0 - победитель
+ * (источник с наименьшей текущей записью). После извлечения записи из победителя
+ * достаточно пройти один путь от листа к корню: log2(k) сравнений.
+ */
+class LoserTree {
+public:
+    /**
+     * @brief Строит дерево по текущим записям источников.
+     * @param heads Текущие записи источников (дерево хранит ссылку на вектор).
+     * @param exhausted Флаги исчерпания источников (дерево хранит ссылку на вектор).
+     */
+    LoserTree(const std::vector<Service>& heads, const std::vector<char>& exhausted)
+        : heads(heads), exhausted(exhausted), k(heads.size()), tree(std::max<size_t>(heads.size(), 1), heads.size()) {
+        for (size_t i = k; i-- > 0;) {
+            adjust(i);
+        }
+    }
+
+    /**
+     * @brief Возвращает индекс источника с наименьшей текущей записью.
+     */
+    size_t winner() const { return tree[0]; }
+
+    /**
+     * @brief Восстанавливает дерево после изменения текущей записи источника leaf.
+     */
+    void adjust(size_t leaf) {
+        size_t s = leaf;
+        for (size_t t = (s + k) / 2; t > 0; t /= 2) {
+            if (less(tree[t], s)) std::swap(s, tree[t]);
+        }
+        tree[0] = s;
+    }
+
+private:
+    bool less(size_t a, size_t b) const {
+        if (a == k) return b != k;      // k - виртуальный минимальный источник при построении
+        if (b == k) return false;
+        if (exhausted[a]) return false;
+        if (exhausted[b]) return true;
+        return heads[a] < heads[b];
+    }
+
+    const std::vector<Service>& heads;
+    const std::vector<char>& exhausted;
+    size_t k;
+    std::vector<size_t> tree;
+};
+
+
+/**
+ * @brief Сливает отсортированные серии с помощью дерева проигравших.
+ * @tparam Emit Тип функции-приемника, вызываемой для каждой записи в порядке возрастания.
+ * @param runPaths Пути к файлам серий.
+ * @param blockBytes Размер блока чтения каждой серии.
+ * @param emit Приемник записей.
+ */
+template<typename Emit>
+void mergeRuns(const std::vector<std::string>& runPaths, size_t blockBytes, Emit emit) {
+    std::vector<std::unique_ptr<RunReader>> readers;
+    std::vector<Service> heads(runPaths.size());
+    std::vector<char> exhausted(runPaths.size(), 0);
+    for (size_t i = 0; i < runPaths.size(); ++i) {
+        readers.push_back(std::make_unique<RunReader>(runPaths[i], blockBytes));
+        exhausted[i] = !readers[i]->next(heads[i]);
+    }
+    if (runPaths.empty()) return;
+
+    LoserTree tree(heads, exhausted);
+    while (true) {
+        size_t w = tree.winner();
+        if (exhausted[w]) break;
+        emit(heads[w]);
+        exhausted[w] = !readers[w]->next(heads[w]);
+        tree.adjust(w);
+    }
+}
+
+
+/**
+ * @brief Сортирует CSV-файл, который может не помещаться в память (внешняя сортировка слиянием).
+ * Входной файл читается блоками (streamServices); записи накапливаются, пока их объем не превысит бюджет памяти,
+ * затем порция сортируется std::sort (порядок Service::operator<) и сбрасывается во временный файл.
+ * Серии сливаются деревом проигравших с асинхронной предвыборкой блоков (при большом количестве
+ * серий - в несколько проходов), результат записывается в формате saveServices через CsvBlockWriter.
+ * @param inputFilename Путь к входному CSV-файлу.
+ * @param outputFilename Путь к выходному CSV-файлу.
+ * @param config Параметры сортировки.
+ * @param stats Статистика выполнения (выходной параметр).
+ * @return True, если сортировка прошла успешно, иначе false.
+ * @throws std::runtime_error Если входной, выходной или временный файл не удается открыть.
+ */
+bool externalSort(const std::string& inputFilename, const std::string& outputFilename,
+                  const ExternalSortConfig& config, ExternalSortStats& stats) {
+    stats = ExternalSortStats();
+    std::filesystem::path tempDirectory = config.tempDirectory.empty()
+        ? std::filesystem::temp_directory_path() : std::filesystem::path(config.tempDirectory);
+    std::string runPrefix = "external_sort_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_";
+    size_t nextRunId = 0;
+    auto newRunPath = [&]() { return (tempDirectory / (runPrefix + std::to_string(nextRunId++) + ".run")).string(); };
+
+    struct TempFiles {
+        std::vector<std::string> paths;
+        ~TempFiles() {
+            for (const auto& path : paths) {
+                std::error_code ignored;
+                std::filesystem::remove(path, ignored);
+            }
+        }
+    } tempFiles;
+    std::vector<std::string>& allRunPaths = tempFiles.paths;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> runPaths;
+    std::vector<Service> chunk;
+    size_t chunkBytes = 0;
+    auto spill = [&]() {
+        if (chunk.empty()) return;
+        std::sort(chunk.begin(), chunk.end());
+        std::string path = newRunPath();
+        allRunPaths.push_back(path);
+        RunWriter writer(path, config.readBlockBytes);
+        for (const auto& service : chunk) writer.write(service);
+        writer.close();
+        runPaths.push_back(path);
+        chunk.clear();
+        chunkBytes = 0;
+    };
+
+    bool readOk = streamServices(inputFilename, config.readBlockBytes, [&](const ServiceView& view) {
+        chunk.emplace_back(std::string(view.name), view.cost, view.duration, view.prepayment);
+        chunkBytes += sizeof(Service) + view.name.size();
+        ++stats.records;
+        if (chunkBytes >= config.memoryBudgetBytes) spill();
+    });
+    if (!readOk) return false;
+    spill();
+    stats.runs = runPaths.size();
+    auto runsDone = std::chrono::steady_clock::now();
+
+    size_t fanIn = std::max<size_t>(2, config.maxMergeFanIn);
+    size_t mergeBlock = std::max<size_t>(64u << 10, config.memoryBudgetBytes / (2 * (std::min(fanIn, std::max<size_t>(runPaths.size(), 1)) + 1)));
+    mergeBlock = std::min(mergeBlock, config.readBlockBytes);
+    while (runPaths.size() > fanIn) {
+        std::vector<std::string> merged;
+        for (size_t first = 0; first < runPaths.size(); first += fanIn) {
+            std::vector<std::string> group(runPaths.begin() + first, runPaths.begin() + std::min(runPaths.size(), first + fanIn));
+            std::string path = newRunPath();
+            allRunPaths.push_back(path);
+            RunWriter writer(path, config.readBlockBytes);
+            mergeRuns(group, mergeBlock, [&writer](const Service& service) { writer.write(service); });
+            writer.close();
+            merged.push_back(path);
+        }
+        runPaths.swap(merged);
+        ++stats.mergePasses;
+    }
+
+    CsvBlockWriter outFile(outputFilename, true, config.readBlockBytes);
+    outFile.write("Название услуги,Ориентировочная стоимость,Срок исполнения (дни),Размер предоплаты\n");
+    mergeRuns(runPaths, mergeBlock, [&outFile](const Service& service) {
+        outFile.writeService(service.name, service.cost, service.duration, service.prepayment);
+    });
+    ++stats.mergePasses;
+    bool ok = outFile.close();
+    auto end = std::chrono::steady_clock::now();
+
+    stats.runPhaseMs = std::chrono::duration<double, std::milli>(runsDone - start).count();
+    stats.mergePhaseMs = std::chrono::duration<double, std::milli>(end - runsDone).count();
+    if (!ok) {
+        std::cerr << "Ошибка записи в файл: " << outputFilename << std::endl;
+    }
+    return ok;
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service методом пузырька.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+void bubbleSort(std::vector<Service>& arr) {
+    int n = arr.size();
+    using std::swap;
+    for (int i = 0; i < n - 1; ++i) {
+        for (int j = 0; j < n - i - 1; ++j) {
+            if (arr[j] > arr[j + 1]) {
+                swap(arr[j], arr[j + 1]);
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service методом вставок.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+void insertionSort(std::vector<Service>& arr) {
+    int n = arr.size();
+    for (int i = 1; i < n; ++i) {
+        Service key = arr[i];
+        int j = i - 1;
+        while (j >= 0 && arr[j] > key) {
+            arr[j + 1] = arr[j];
+            j = j - 1;
+        }
+        arr[j + 1] = key;
+    }
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service методом Шейкера (двунаправленная пузырьковая).
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+void shakerSort(std::vector<Service>& arr) {
+    int n = arr.size();
+    bool swapped = true;
+    int start = 0;
+    int end = n - 1;
+    using std::swap;
+
+    while (swapped) {
+        swapped = false;
+        for (int i = start; i < end; ++i) {
+            if (arr[i] > arr[i + 1]) {
+                swap(arr[i], arr[i + 1]);
+                swapped = true;
+            }
+        }
+        if (!swapped) break;
+
+        swapped = false;
+        --end;
+
+        for (int i = end - 1; i >= start; --i) {
+            if (arr[i] > arr[i + 1]) {
+                swap(arr[i], arr[i + 1]);
+                swapped = true;
+            }
+        }
+        ++start;
+    }
+}
+
+
+/**
+ * @brief Компактный ключ сортировки, извлеченный из Service.
+ *
+ * Содержит числовые поля сравнения, первые 8 байт названия (в порядке big-endian,
+ * чтобы сравнение чисел совпадало с побайтовым сравнением строк) и индекс исходной записи.
+ */
+struct ServiceSortKey {
+    double cost;            ///< Ориентировочная стоимость
+    double prepayment;      ///< Размер предоплаты
+    uint64_t namePrefix;    ///< Первые 8 байт названия, дополненные нулями
+    uint32_t index;         ///< Индекс записи в исходном векторе
+};
+
+
+/**
+ * @brief Упаковывает первые 8 байт строки в число так, чтобы порядок чисел совпадал с порядком строк.
+ * @param name Строка.
+ * @return Префикс строки в порядке big-endian, дополненный нулевыми байтами.
+ */
+inline uint64_t makeNamePrefix(std::string_view name) {
+    uint64_t prefix = 0;
+    size_t length = std::min<size_t>(name.size(), 8);
+    for (size_t i = 0; i < 8; ++i) {
+        prefix <<= 8;
+        if (i < length) {
+            prefix |= static_cast<unsigned char>(name[i]);
+        }
+    }
+    return prefix;
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service через массив извлеченных ключей.
+ * Сначала строится массив ServiceSortKey, сортируется только он (полное сравнение названий
+ * выполняется лишь при совпадении префиксов), затем записи переставляются одним проходом.
+ * Результат совпадает с std::sort по Service::operator<.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+void keySort(std::vector<Service>& arr) {
+    size_t n = arr.size();
+    std::vector<ServiceSortKey> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = {arr[i].cost, arr[i].prepayment, makeNamePrefix(arr[i].name), static_cast<uint32_t>(i)};
+    }
+
+    std::sort(keys.begin(), keys.end(), [&arr](const ServiceSortKey& a, const ServiceSortKey& b) {
+        if (a.cost != b.cost) {
+            return a.cost < b.cost;
+        }
+        if (a.prepayment != b.prepayment) {
+            return a.prepayment < b.prepayment;
+        }
+        if (a.namePrefix != b.namePrefix) {
+            return a.namePrefix < b.namePrefix;
+        }
+        return arr[a.index].name < arr[b.index].name;
+    });
+
+    std::vector<Service> sorted;
+    sorted.reserve(n);
+    for (const auto& key : keys) {
+        sorted.push_back(std::move(arr[key.index]));
+    }
+    arr.swap(sorted);
+}
+
+
+/**
+ * @brief Преобразует double в 64-битное беззнаковое число с тем же порядком.
+ * Для неотрицательных чисел достаточно инвертировать знаковый бит, для отрицательных
+ * инвертируются все биты. -0.0 приводится к 0.0, чтобы порядок совпадал с operator<.
+ * @param value Исходное значение.
+ * @return Ключ, сохраняющий порядок при беззнаковом сравнении.
+ */
+inline uint64_t sortableDoubleBits(double value) {
+    value += 0.0;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+}
+
+
+/**
+ * @brief Ключ поразрядной сортировки: два 64-битных ключа с порядком беззнакового сравнения и индекс записи.
+ * Для порядка Service::operator< это упорядоченные биты стоимости и предоплаты.
+ */
+struct RadixSortKey {
+    uint64_t primary;       ///< Старший ключ (например, sortableDoubleBits(cost))
+    uint64_t secondary;     ///< Младший ключ (например, sortableDoubleBits(prepayment))
+    uint32_t index;         ///< Индекс записи в исходных данных
+};
+
+
+/**
+ * @brief Сортирует массив ключей поразрядной сортировкой (LSD) по 128-битному ключу.
+ * Ключ - primary (старшие 64 бита) и secondary (младшие 64 бита), по 8 бит за проход;
+ * проходы, в которых все ключи попадают в одну корзину, пропускаются. Ключи с равными
+ * значениями досортировываются с помощью tieLess (для Service::operator< - по названию).
+ * @tparam TieLess Тип предиката сравнения записей с равными ключами по их индексам.
+ * @param keys Массив ключей (сортируется на месте).
+ * @param tieLess Предикат tieLess(i, j): запись i меньше записи j.
+ */
+template<typename TieLess>
+void radixSortKeys(std::vector<RadixSortKey>& keys, TieLess tieLess) {
+    size_t n = keys.size();
+    if (n < 2) return;
+
+    std::vector<RadixSortKey> buffer(n);
+    std::vector<std::array<size_t, 256>> counts(16);
+    for (auto& count : counts) count.fill(0);
+
+    for (const auto& key : keys) {
+        for (int b = 0; b < 8; ++b) {
+            ++counts[b][(key.secondary >> (8 * b)) & 0xFF];
+            ++counts[8 + b][(key.primary >> (8 * b)) & 0xFF];
+        }
+    }
+
+    for (int pass = 0; pass < 16; ++pass) {
+        auto& count = counts[pass];
+        uint64_t firstKey = pass < 8 ? keys[0].secondary : keys[0].primary;
+        int shift = 8 * (pass % 8);
+        if (count[(firstKey >> shift) & 0xFF] == n) continue;
+
+        size_t offset = 0;
+        for (auto& c : count) {
+            size_t bucketSize = c;
+            c = offset;
+            offset += bucketSize;
+        }
+        for (const auto& key : keys) {
+            uint64_t value = pass < 8 ? key.secondary : key.primary;
+            buffer[count[(value >> shift) & 0xFF]++] = key;
+        }
+        keys.swap(buffer);
+    }
+
+    size_t runStart = 0;
+    for (size_t i = 1; i <= n; ++i) {
+        if (i == n || keys[i].primary != keys[runStart].primary || keys[i].secondary != keys[runStart].secondary) {
+            if (i - runStart > 1) {
+                std::sort(keys.begin() + runStart, keys.begin() + i, [&tieLess](const RadixSortKey& a, const RadixSortKey& b) {
+                    return tieLess(a.index, b.index);
+                });
+            }
+            runStart = i;
+        }
+    }
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service поразрядной сортировкой (LSD) по битам IEEE-754.
+ * Строит массив RadixSortKey, сортирует его radixSortKeys и переставляет записи одним проходом.
+ * Результат совпадает с Service::operator<.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+void radixSort(std::vector<Service>& arr) {
+    size_t n = arr.size();
+    if (n < 2) return;
+
+    std::vector<RadixSortKey> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = {sortableDoubleBits(arr[i].cost), sortableDoubleBits(arr[i].prepayment), static_cast<uint32_t>(i)};
+    }
+    radixSortKeys(keys, [&arr](uint32_t a, uint32_t b) { return arr[a].name < arr[b].name; });
+
+    std::vector<Service> sorted;
+    sorted.reserve(n);
+    for (const auto& key : keys) {
+        sorted.push_back(std::move(arr[key.index]));
+    }
+    arr.swap(sorted);
+}
+
+
+/**
+ * @brief Поле записи Service, по которому может выполняться сортировка.
+ */
+enum class SortField {
+    Cost,             ///< Ориентировочная стоимость
+    Prepayment,       ///< Размер предоплаты
+    Duration,         ///< Срок исполнения
+    Name,             ///< Название
+    PrepaymentRatio   ///< Доля предоплаты в стоимости (prepayment / cost, 0 при нулевой стоимости)
+};
+
+
+/**
+ * @brief Направление сортировки по полю.
+ */
+enum class SortOrder {
+    Ascending,   ///< По возрастанию
+    Descending   ///< По убыванию
+};
+
+
+/**
+ * @brief Возвращает имя поля в спецификации сортировки (cost, prepayment, duration, name, ratio).
+ */
+const char* sortFieldName(SortField field) {
+    switch (field) {
+        case SortField::Cost: return "cost";
+        case SortField::Prepayment: return "prepayment";
+        case SortField::Duration: return "duration";
+        case SortField::Name: return "name";
+        case SortField::PrepaymentRatio: return "ratio";
+    }
+    return "unknown";
+}
+
+
+/**
+ * @brief Ключ сортировки: поле и направление, известные на этапе компиляции.
+ * Для каждой пары генерируется отдельное трехзначное сравнение без ветвления по виду поля
+ * и извлечение 64-битного ключа, порядок беззнакового сравнения которого совпадает с порядком поля.
+ * @tparam Field Поле записи.
+ * @tparam Order Направление.
+ */
+template<SortField Field, SortOrder Order = SortOrder::Ascending>
+struct SortKey {
+    static constexpr SortField field = Field;
+    static constexpr bool descending = Order == SortOrder::Descending;
+    /// Ключ extract() полностью определяет порядок (для названия это лишь префикс из 8 байт).
+    static constexpr bool exactKey = Field != SortField::Name;
+
+    /**
+     * @brief Трехзначное сравнение записей по полю с учетом направления.
+     * @return Отрицательное число, 0 или положительное число, если a предшествует, равна или следует за b.
+     */
+    static int compare(const Service& a, const Service& b) {
+        int result;
+        if constexpr (Field == SortField::Name) {
+            int c = a.name.compare(b.name);
+            result = (c > 0) - (c < 0);
+        } else {
+            auto x = value(a);
+            auto y = value(b);
+            result = (x > y) - (x < y);
+        }
+        return descending ? -result : result;
+    }
+
+    /**
+     * @brief Извлекает 64-битный ключ для сортировки по извлеченным ключам и поразрядной сортировки.
+     */
+    static uint64_t extract(const Service& s) {
+        uint64_t bits;
+        if constexpr (Field == SortField::Name) {
+            bits = makeNamePrefix(s.name);
+        } else if constexpr (Field == SortField::Duration) {
+            bits = static_cast<uint32_t>(s.duration) ^ 0x80000000u;
+        } else {
+            bits = sortableDoubleBits(value(s));
+        }
+        return descending ? ~bits : bits;
+    }
+
+private:
+    static auto value(const Service& s) {
+        if constexpr (Field == SortField::Cost) {
+            return s.cost;
+        } else if constexpr (Field == SortField::Prepayment) {
+            return s.prepayment;
+        } else if constexpr (Field == SortField::Duration) {
+            return s.duration;
+        } else {
+            return s.cost != 0.0 ? s.prepayment / s.cost : 0.0;
+        }
+    }
+};
+
+
+/**
+ * @brief Спецификация многоключевой сортировки: список ключей в порядке приоритета.
+ * Каждый следующий ключ разрешает равенство предыдущих. Экземпляр - компаратор для std::sort;
+ * сравнение разворачивается в последовательность SortKey::compare без цикла по списку полей.
+ * Например, SortSpec<SortKey<SortField::Duration>, SortKey<SortField::Cost, SortOrder::Descending>>.
+ * @tparam Keys Типы SortKey.
+ */
+template<typename... Keys>
+struct SortSpec {
+    static_assert(sizeof...(Keys) > 0, "SortSpec: нужен хотя бы один ключ");
+
+    /**
+     * @brief Количество ведущих ключей, кодируемых в RadixSortKey (не больше двух; после неточного ключа - ни одного).
+     */
+    static constexpr size_t radixKeyCount() {
+        constexpr bool exact[] = {Keys::exactKey...};
+        size_t count = 0;
+        while (count < sizeof...(Keys) && count < 2) {
+            if (!exact[count++]) break;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Трехзначное сравнение по всем ключам спецификации.
+     */
+    static int compare(const Service& a, const Service& b) {
+        int result = 0;
+        (void)(((result = Keys::compare(a, b)) != 0) || ...);
+        return result;
+    }
+
+    /**
+     * @brief Оператор "меньше" для std::sort.
+     */
+    bool operator()(const Service& a, const Service& b) const {
+        return compare(a, b) < 0;
+    }
+
+    /**
+     * @brief Строит ключ поразрядной сортировки из первых radixKeyCount() ключей спецификации.
+     */
+    static RadixSortKey radixKey(const Service& s, uint32_t index) {
+        uint64_t extracted[] = {Keys::extract(s)...};
+        constexpr size_t count = radixKeyCount();
+        return {extracted[0], count > 1 ? extracted[1] : 0, index};
+    }
+
+    /**
+     * @brief Текстовое описание спецификации, например "duration,-cost" (минус - по убыванию).
+     */
+    static std::string description() {
+        std::string result;
+        ((result += (result.empty() ? "" : ",") + std::string(Keys::descending ? "-" : "") + sortFieldName(Keys::field)), ...);
+        return result;
+    }
+};
+
+
+/**
+ * @brief Порядок Service::operator< в виде спецификации: стоимость, предоплата, название.
+ */
+using DefaultSortSpec = SortSpec<SortKey<SortField::Cost>, SortKey<SortField::Prepayment>, SortKey<SortField::Name>>;
+
+
+/**
+ * @brief Сортирует вектор объектов Service по спецификации через массив извлеченных ключей.
+ * Как keySort: сортируются пары (ключ первого поля, индекс), полное сравнение спецификации
+ * выполняется только при равных ключах, затем записи переставляются одним проходом.
+ * @tparam Spec Спецификация SortSpec.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+template<typename Spec>
+void specKeySort(std::vector<Service>& arr) {
+    size_t n = arr.size();
+    std::vector<RadixSortKey> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = Spec::radixKey(arr[i], static_cast<uint32_t>(i));
+    }
+
+    std::sort(keys.begin(), keys.end(), [&arr](const RadixSortKey& a, const RadixSortKey& b) {
+        if (a.primary != b.primary) {
+            return a.primary < b.primary;
+        }
+        if (a.secondary != b.secondary) {
+            return a.secondary < b.secondary;
+        }
+        return Spec::compare(arr[a.index], arr[b.index]) < 0;
+    });
+
+    std::vector<Service> sorted;
+    sorted.reserve(n);
+    for (const auto& key : keys) {
+        sorted.push_back(std::move(arr[key.index]));
+    }
+    arr.swap(sorted);
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service по спецификации поразрядной сортировкой.
+ * Первые radixKeyCount() ключей спецификации сортируются radixSortKeys, остальные (и
+ * неточный ключ названия) разрешаются полным сравнением спецификации в группах равных ключей.
+ * @tparam Spec Спецификация SortSpec.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+template<typename Spec>
+void specRadixSort(std::vector<Service>& arr) {
+    size_t n = arr.size();
+    if (n < 2) return;
+
+    std::vector<RadixSortKey> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = Spec::radixKey(arr[i], static_cast<uint32_t>(i));
+    }
+    radixSortKeys(keys, [&arr](uint32_t a, uint32_t b) { return Spec::compare(arr[a], arr[b]) < 0; });
+
+    std::vector<Service> sorted;
+    sorted.reserve(n);
+    for (const auto& key : keys) {
+        sorted.push_back(std::move(arr[key.index]));
+    }
+    arr.swap(sorted);
+}
+
+
+/**
+ * @brief Ключ сортировки, заданный во время выполнения (для сравнения с SortSpec).
+ */
+struct RuntimeSortKey {
+    SortField field;    ///< Поле записи
+    SortOrder order;    ///< Направление
+};
+
+
+/**
+ * @brief Разбирает спецификацию вида "duration,-cost,name" (минус перед полем - по убыванию).
+ * @param text Текст спецификации.
+ * @return Список ключей в порядке приоритета.
+ * @throws std::runtime_error Если поле неизвестно или список пуст.
+ */
+std::vector<RuntimeSortKey> parseSortSpec(const std::string& text) {
+    std::vector<RuntimeSortKey> keys;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        SortOrder order = SortOrder::Ascending;
+        if (!item.empty() && item[0] == '-') {
+            order = SortOrder::Descending;
+            item.erase(0, 1);
+        }
+        bool known = false;
+        for (SortField field : {SortField::Cost, SortField::Prepayment, SortField::Duration, SortField::Name, SortField::PrepaymentRatio}) {
+            if (item == sortFieldName(field)) {
+                keys.push_back({field, order});
+                known = true;
+            }
+        }
+        if (!known) {
+            throw std::runtime_error("Ошибка: Неизвестное поле сортировки '" + item + "' в спецификации: " + text);
+        }
+    }
+    if (keys.empty()) {
+        throw std::runtime_error("Ошибка: Пустая спецификация сортировки.");
+    }
+    return keys;
+}
+
+
+/**
+ * @brief Строит универсальный компаратор, который на каждом сравнении обходит список ключей и выбирает поле по switch.
+ * Это прежний способ сортировки по произвольным полям; SortSpec дает тот же порядок.
+ * @param keys Ключи в порядке приоритета.
+ * @return Оператор "меньше" для std::sort.
+ */
+std::function<bool(const Service&, const Service&)> makeRuntimeComparator(std::vector<RuntimeSortKey> keys) {
+    return [keys = std::move(keys)](const Service& a, const Service& b) {
+        for (const auto& key : keys) {
+            int c = 0;
+            switch (key.field) {
+                case SortField::Cost: c = (a.cost > b.cost) - (a.cost < b.cost); break;
+                case SortField::Prepayment: c = (a.prepayment > b.prepayment) - (a.prepayment < b.prepayment); break;
+                case SortField::Duration: c = (a.duration > b.duration) - (a.duration < b.duration); break;
+                case SortField::Name: c = a.name.compare(b.name); c = (c > 0) - (c < 0); break;
+                case SortField::PrepaymentRatio: {
+                    double x = a.cost != 0.0 ? a.prepayment / a.cost : 0.0;
+                    double y = b.cost != 0.0 ? b.prepayment / b.cost : 0.0;
+                    c = (x > y) - (x < y);
+                    break;
+                }
+            }
+            if (c != 0) return key.order == SortOrder::Descending ? c > 0 : c < 0;
+        }
+        return false;
+    };
+}
+
+
+/**
+ * @brief Спецификации с компараторами времени компиляции: замеряются runSortSpecBenchmark и
+ * подставляются SortService вместо makeRuntimeComparator, если текст спецификации совпадает.
+ */
+using KnownSortSpecs = std::tuple<
+    DefaultSortSpec,
+    SortSpec<SortKey<SortField::Duration>, SortKey<SortField::Cost, SortOrder::Descending>, SortKey<SortField::Name>>,
+    SortSpec<SortKey<SortField::PrepaymentRatio, SortOrder::Descending>, SortKey<SortField::Name>>,
+    SortSpec<SortKey<SortField::Name, SortOrder::Descending>, SortKey<SortField::Duration>>>;
+
+
+/**
+ * @brief Вызывает visitor(Spec()) для спецификации из KnownSortSpecs с теми же ключами.
+ * @param keys Ключи, разобранные parseSortSpec.
+ * @param visitor Функция, принимающая экземпляр SortSpec.
+ * @return True, если спецификация нашлась; иначе visitor не вызывается.
+ */
+template<typename Visitor>
+bool visitKnownSortSpec(const std::vector<RuntimeSortKey>& keys, Visitor&& visitor) {
+    std::string description;
+    for (const auto& key : keys) {
+        description += (description.empty() ? "" : ",") + std::string(key.order == SortOrder::Descending ? "-" : "") + sortFieldName(key.field);
+    }
+    return std::apply([&](auto... specs) {
+        return ((description == decltype(specs)::description() && (visitor(specs), true)) || ...);
+    }, KnownSortSpecs());
+}
+
+
+/**
+ * @brief Порядок сравнения названий услуг.
+ */
+enum class NameCollation {
+    Binary,   ///< Побайтовый порядок std::string (как в Service::operator<)
+    Russian   ///< Русский алфавитный порядок без учета регистра (ё после е), как в правилах сопоставления ICU
+};
+
+
+/**
+ * @brief Возвращает имя режима сопоставления (binary, russian).
+ */
+const char* nameCollationName(NameCollation collation) {
+    return collation == NameCollation::Binary ? "binary" : "russian";
+}
+
+
+/**
+ * @brief Декодирует один символ UTF-8 и переходит к следующему.
+ * Некорректный байт возвращается как есть (как символ из диапазона Latin-1).
+ * @param p Текущая позиция (сдвигается за символ).
+ * @param last Конец строки.
+ * @return Код символа.
+ */
+inline uint32_t decodeUtf8(const char*& p, const char* last) {
+    unsigned char lead = static_cast<unsigned char>(*p++);
+    if (lead < 0x80) return lead;
+    int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+    if (extra == 0 || last - p < extra) return lead;
+    uint32_t code = lead & (0x3F >> extra);
+    for (int i = 0; i < extra; ++i) {
+        unsigned char next = static_cast<unsigned char>(p[i]);
+        if ((next & 0xC0) != 0x80) return lead;
+        code = (code << 6) | (next & 0x3F);
+    }
+    p += extra;
+    return code;
+}
+
+
+/**
+ * @brief Строит ключ сопоставления названия для русского порядка.
+ *
+ * Ключ сравнивается побайтово (memcmp) и состоит из трех уровней, разделенных нулями:
+ * первичные веса символов (по 2 байта: пробелы и знаки, цифры, латиница, кириллица, прочие символы),
+ * вторичные (ё отличается от е) и третичные (строчная буква раньше прописной).
+ * Без учета регистра и ё названия упорядочены по алфавиту; различия в них разрешаются на следующих уровнях.
+ * @param name Название в UTF-8.
+ * @return Ключ сопоставления.
+ */
+std::string makeRussianCollationKey(std::string_view name) {
+    std::string primary;
+    std::string secondary;
+    std::string tertiary;
+    primary.reserve(name.size() * 4 + 3);
+    secondary.reserve(name.size());
+    tertiary.reserve(name.size());
+    const char* p = name.data();
+    const char* last = p + name.size();
+    while (p < last) {
+        uint32_t code = decodeUtf8(p, last);
+        uint32_t weight;
+        bool upper = false;
+        bool yo = false;
+        if (code >= 'A' && code <= 'Z') {
+            upper = true;
+            code += 'a' - 'A';
+        } else if (code >= 0x410 && code <= 0x42F) {
+            upper = true;
+            code += 0x20;
+        } else if (code == 0x401) {
+            upper = true;
+            code = 0x451;
+        }
+        if (code >= 'a' && code <= 'z') {
+            weight = 0x0500 + (code - 'a');
+        } else if (code >= '0' && code <= '9') {
+            weight = 0x0400 + (code - '0');
+        } else if (code == 0x451) {
+            yo = true;
+            weight = 0x0600 + (0x435 - 0x430);
+        } else if (code >= 0x430 && code <= 0x44F) {
+            weight = 0x0600 + (code - 0x430);
+        } else if (code < 0x80) {
+            weight = 0x0100 + code;
+        } else if (code >= 0xA0 && code < 0xC0) {
+            weight = 0x0200 + (code - 0xA0);
+        } else if (code >= 0x2000 && code < 0x2070) {
+            weight = 0x0300 + (code - 0x2000);
+        } else {
+            weight = 0x1000 + std::min<uint32_t>(code, 0xEFFF);
+        }
+        primary.push_back(static_cast<char>(weight >> 8));
+        primary.push_back(static_cast<char>(weight & 0xFF));
+        secondary.push_back(static_cast<char>(yo ? 2 : 1));
+        tertiary.push_back(static_cast<char>(upper ? 2 : 1));
+    }
+    std::string key = std::move(primary);
+    key.append(2, '\0');
+    key += secondary;
+    key.push_back('\0');
+    key += tertiary;
+    return key;
+}
+
+
+/**
+ * @brief Упаковывает первые 16 байт строки в два числа с порядком беззнакового сравнения (см. makeNamePrefix).
+ */
+inline std::array<uint64_t, 2> makeNamePrefix16(std::string_view bytes) {
+    return {makeNamePrefix(bytes), makeNamePrefix(bytes.size() > 8 ? bytes.substr(8) : std::string_view())};
+}
+
+
+/**
+ * @brief Ключ сортировки с предвычисленным 16-байтным префиксом названия (или ключа сопоставления).
+ */
+struct CollatedSortKey {
+    double cost;                    ///< Ориентировочная стоимость
+    double prepayment;              ///< Размер предоплаты
+    std::array<uint64_t, 2> prefix; ///< Первые 16 байт названия (binary) или ключа сопоставления (russian)
+    uint32_t index;                 ///< Индекс записи в CollatedServices::services
+};
+
+
+/**
+ * @brief Набор услуг с ключами сортировки, вычисленными один раз при загрузке.
+ *
+ * Порядок: стоимость, предоплата, затем название в выбранном режиме сопоставления. При равных
+ * числовых полях названия сравниваются одним сравнением 16-байтных префиксов; полные ключи
+ * (и побайтовое сравнение названий для полной упорядоченности) нужны, только если совпали и префиксы.
+ * Сортировка переставляет только keys; записи остаются на местах.
+ */
+struct CollatedServices {
+    NameCollation collation = NameCollation::Binary;
+    std::vector<Service> services;           ///< Записи в порядке загрузки
+    std::vector<CollatedSortKey> keys;       ///< Ключи; после collatedSort - в отсортированном порядке
+    std::vector<std::string> collationKeys;  ///< Полные ключи сопоставления по индексу записи (только russian)
+
+    /**
+     * @brief Строит ключи для набора записей.
+     * @param source Записи.
+     * @param collation Режим сопоставления названий.
+     */
+    static CollatedServices fromServices(std::vector<Service> source, NameCollation collation) {
+        CollatedServices data;
+        data.collation = collation;
+        data.services = std::move(source);
+        size_t n = data.services.size();
+        data.keys.resize(n);
+        if (collation == NameCollation::Russian) data.collationKeys.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            const Service& s = data.services[i];
+            std::string_view nameKey = s.name;
+            if (collation == NameCollation::Russian) {
+                data.collationKeys[i] = makeRussianCollationKey(s.name);
+                nameKey = data.collationKeys[i];
+            }
+            data.keys[i] = {s.cost, s.prepayment, makeNamePrefix16(nameKey), static_cast<uint32_t>(i)};
+        }
+        return data;
+    }
+
+    /**
+     * @brief Возвращает записи в порядке keys.
+     */
+    std::vector<Service> toServices() const {
+        std::vector<Service> result;
+        result.reserve(keys.size());
+        for (const auto& key : keys) result.push_back(services[key.index]);
+        return result;
+    }
+};
+
+
+/**
+ * @brief Загружает CSV-файл и сразу строит ключи сопоставления названий.
+ * @param filename Путь к CSV-файлу.
+ * @param data Набор с ключами (выходной параметр).
+ * @param collation Режим сопоставления названий.
+ * @return True, если загрузка прошла успешно, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть.
+ */
+bool loadServicesCollated(const std::string& filename, CollatedServices& data, NameCollation collation) {
+    std::vector<Service> services;
+    bool ok = loadServices(filename, services);
+    data = CollatedServices::fromServices(std::move(services), collation);
+    return ok;
+}
+
+
+/**
+ * @brief Сортирует ключи набора: стоимость, предоплата, префикс названия, затем полные ключи.
+ * @param data Набор с ключами (сортируется data.keys).
+ */
+void collatedSort(CollatedServices& data) {
+    const std::vector<Service>& services = data.services;
+    const std::vector<std::string>& collationKeys = data.collationKeys;
+    bool russian = data.collation == NameCollation::Russian;
+    std::sort(data.keys.begin(), data.keys.end(), [&](const CollatedSortKey& a, const CollatedSortKey& b) {
+        if (a.cost != b.cost) {
+            return a.cost < b.cost;
+        }
+        if (a.prepayment != b.prepayment) {
+            return a.prepayment < b.prepayment;
+        }
+        if (a.prefix != b.prefix) {
+            return a.prefix < b.prefix;
+        }
+        if (russian) {
+            int c = collationKeys[a.index].compare(collationKeys[b.index]);
+            if (c != 0) return c < 0;
+        }
+        return services[a.index].name < services[b.index].name;
+    });
+}
+
+
+/**
+ * @brief Сравнивает услуги в русском порядке названий, вычисляя ключи сопоставления при каждом сравнении.
+ * Дает тот же порядок, что collatedSort в режиме Russian; используется как базовый вариант в замерах.
+ */
+bool russianCollationLess(const Service& a, const Service& b) {
+    if (a.cost != b.cost) {
+        return a.cost < b.cost;
+    }
+    if (a.prepayment != b.prepayment) {
+        return a.prepayment < b.prepayment;
+    }
+    int c = makeRussianCollationKey(a.name).compare(makeRussianCollationKey(b.name));
+    if (c != 0) return c < 0;
+    return a.name < b.name;
+}
+
+
+/**
+ * @brief Агрегаты по корзине стоимости: различные услуги с cost в [bucketStart, bucketStart + ширина).
+ */
+struct CostBucketAggregate {
+    double bucketStart = 0.0;       ///< Нижняя граница корзины (кратна ширине)
+    size_t count = 0;               ///< Количество различных услуг
+    double totalDuration = 0.0;     ///< Суммарный срок исполнения
+    double totalPrepayment = 0.0;   ///< Суммарная предоплата
+
+    /**
+     * @brief Возвращает средний срок исполнения в корзине.
+     */
+    double averageDuration() const { return count ? totalDuration / count : 0.0; }
+};
+
+
+/**
+ * @brief Ширина корзины стоимости для агрегатов по умолчанию.
+ */
+const double DEFAULT_COST_BUCKET_WIDTH = 10000.0;
+
+/**
+ * @brief Размер блока, который совмещенная сортировка с редукцией сортирует и очищает от дубликатов в кэше.
+ */
+const size_t SORT_REDUCE_BLOCK = 2048;
+
+
+/**
+ * @brief Добавляет запись к агрегатам. Записи должны поступать по неубыванию стоимости,
+ * тогда каждая корзина - один последний элемент aggregates.
+ */
+inline void addToCostBuckets(std::vector<CostBucketAggregate>& aggregates, const Service& service, double bucketWidth) {
+    double bucketStart = std::floor(service.cost / bucketWidth) * bucketWidth;
+    if (aggregates.empty() || aggregates.back().bucketStart != bucketStart) {
+        aggregates.push_back({bucketStart, 0, 0.0, 0.0});
+    }
+    CostBucketAggregate& aggregate = aggregates.back();
+    ++aggregate.count;
+    aggregate.totalDuration += service.duration;
+    aggregate.totalPrepayment += service.prepayment;
+}
+
+
+/**
+ * @brief Вычисляет агрегаты по корзинам стоимости отдельным проходом по отсортированным записям.
+ * @param sorted Записи, отсортированные по Service::operator<.
+ * @param bucketWidth Ширина корзины стоимости.
+ * @return Агрегаты по возрастанию стоимости (только непустые корзины).
+ */
+std::vector<CostBucketAggregate> aggregateByCostBucket(const std::vector<Service>& sorted, double bucketWidth) {
+    std::vector<CostBucketAggregate> aggregates;
+    for (const auto& service : sorted) {
+        addToCostBuckets(aggregates, service, bucketWidth);
+    }
+    return aggregates;
+}
+
+
+/**
+ * @brief Сортирует записи, удаляет дубликаты (Service::operator==) и вычисляет агрегаты тремя проходами:
+ * std::sort, std::unique и aggregateByCostBucket. Базовый вариант для fusedSortReduce.
+ * @param arr Записи (сортируются на месте, дубликаты удаляются).
+ * @param bucketWidth Ширина корзины стоимости.
+ * @param aggregates Агрегаты по корзинам (выходной параметр).
+ */
+void sortUniqueAggregate(std::vector<Service>& arr, double bucketWidth, std::vector<CostBucketAggregate>& aggregates) {
+    std::sort(arr.begin(), arr.end());
+    arr.erase(std::unique(arr.begin(), arr.end()), arr.end());
+    aggregates = aggregateByCostBucket(arr, bucketWidth);
+}
+
+
+/**
+ * @brief Сливает две отсортированные серии без дубликатов в одну, пропуская записи, которые есть в обеих.
+ * @param emit Получает записи результата по порядку (emit(Service&), запись можно переместить).
+ */
+template<typename Emit>
+void mergeUniqueRuns(Service* first1, Service* last1, Service* first2, Service* last2, Emit emit) {
+    while (first1 != last1 && first2 != last2) {
+        if (*first2 < *first1) {
+            emit(*first2++);
+        } else {
+            if (!(*first1 < *first2)) ++first2;
+            emit(*first1++);
+        }
+    }
+    while (first1 != last1) emit(*first1++);
+    while (first2 != last2) emit(*first2++);
+}
+
+
+/**
+ * @brief Сортирует записи, удаляет дубликаты и вычисляет агрегаты по корзинам стоимости за один проход сортировки.
+ *
+ * Блоки по SORT_REDUCE_BLOCK записей сортируются std::sort и сразу сжимаются std::unique, пока они в кэше;
+ * затем серии попарно сливаются (mergeUniqueRuns), и дубликаты из разных серий отбрасываются при слиянии,
+ * поэтому на повторяющихся данных следующие проходы обрабатывают все меньше записей. Агрегаты накапливаются
+ * в последнем слиянии по мере записи результата, без отдельного прохода.
+ * Результат совпадает с sortUniqueAggregate (из равных записей, различающихся только сроком, может остаться другая).
+ * @param arr Записи (сортируются на месте, дубликаты удаляются).
+ * @param bucketWidth Ширина корзины стоимости.
+ * @param aggregates Агрегаты по корзинам (выходной параметр).
+ */
+void fusedSortReduce(std::vector<Service>& arr, double bucketWidth, std::vector<CostBucketAggregate>& aggregates) {
+    aggregates.clear();
+    size_t n = arr.size();
+    std::vector<std::pair<size_t, size_t>> runs;
+    for (size_t first = 0; first < n; first += SORT_REDUCE_BLOCK) {
+        auto runBegin = arr.begin() + first;
+        auto runEnd = arr.begin() + std::min(n, first + SORT_REDUCE_BLOCK);
+        std::sort(runBegin, runEnd);
+        runs.emplace_back(first, std::unique(runBegin, runEnd) - arr.begin());
+    }
+    if (runs.size() <= 1) {
+        size_t last = runs.empty() ? 0 : runs[0].second;
+        for (size_t i = 0; i < last; ++i) addToCostBuckets(aggregates, arr[i], bucketWidth);
+        arr.erase(arr.begin() + last, arr.end());
+        return;
+    }
+
+    std::vector<Service> buffer(n);
+    Service* source = arr.data();
+    Service* target = buffer.data();
+    while (runs.size() > 2) {
+        std::vector<std::pair<size_t, size_t>> merged;
+        size_t out = 0;
+        for (size_t r = 0; r < runs.size(); r += 2) {
+            size_t start = out;
+            if (r + 1 < runs.size()) {
+                mergeUniqueRuns(source + runs[r].first, source + runs[r].second,
+                                source + runs[r + 1].first, source + runs[r + 1].second,
+                                [&](Service& s) { target[out++] = std::move(s); });
+            } else {
+                for (size_t i = runs[r].first; i < runs[r].second; ++i) target[out++] = std::move(source[i]);
+            }
+            merged.emplace_back(start, out);
+        }
+        runs.swap(merged);
+        std::swap(source, target);
+    }
+
+    size_t out = 0;
+    mergeUniqueRuns(source + runs[0].first, source + runs[0].second, source + runs[1].first, source + runs[1].second,
+                    [&](Service& s) {
+                        addToCostBuckets(aggregates, s, bucketWidth);
+                        target[out++] = std::move(s);
+                    });
+    if (target == buffer.data()) {
+        buffer.erase(buffer.begin() + out, buffer.end());
+        arr.swap(buffer);
+    } else {
+        arr.erase(arr.begin() + out, arr.end());
+    }
+}
+
+
+/**
+ * @brief Набор инструкций, которым выполняется SIMD-сортировка ключей.
+ */
+enum class SimdLevel {
+    Scalar,   ///< Без векторных инструкций (та же схема, скалярные ядра)
+    Avx2,     ///< AVX2: 4 ключа в регистре
+    Avx512    ///< AVX-512F: 8 ключей в регистре
+};
+
+
+/**
+ * @brief Возвращает название набора инструкций для вывода и CSV.
+ */
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx512: return "AVX-512";
+        case SimdLevel::Avx2: return "AVX2";
+        default: return "скалярное ядро";
+    }
+}
+
+
+/**
+ * @brief Определяет лучший набор инструкций, поддерживаемый процессором и ОС.
+ */
+SimdLevel detectSimdLevel() {
+#ifdef SORT_BENCH_HAVE_X86_SIMD
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return SimdLevel::Scalar;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave) return SimdLevel::Scalar;
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    bool avx512 = (info[1] & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6;
+#else
+    __builtin_cpu_init();
+    bool avx2 = __builtin_cpu_supports("avx2");
+    bool avx512 = __builtin_cpu_supports("avx512f");
+#endif
+    if (avx512) return SimdLevel::Avx512;
+    if (avx2) return SimdLevel::Avx2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+
+/**
+ * @brief Сортировка вставками пар (ключ, значение) - базовый случай скалярного ядра и запасной путь векторных.
+ */
+void simdInsertionSortScalar(uint64_t* keys, uint64_t* values, size_t n) {
+    for (size_t i = 1; i < n; ++i) {
+        uint64_t key = keys[i];
+        uint64_t value = values[i];
+        size_t j = i;
+        while (j > 0 && keys[j - 1] > key) {
+            keys[j] = keys[j - 1];
+            values[j] = values[j - 1];
+            --j;
+        }
+        keys[j] = key;
+        values[j] = value;
+    }
+}
+
+
+/**
+ * @brief Скалярное разбиение пар через временный буфер: [0, результат) - ключи < pivot (или <= при includeEqual).
+ */
+size_t simdPartitionScalar(uint64_t* keys, uint64_t* values, size_t n, uint64_t pivot, bool includeEqual,
+                           uint64_t* scratchKeys, uint64_t* scratchValues) {
+    size_t left = 0;
+    size_t right = n;
+    for (size_t i = 0; i < n; ++i) {
+        bool toLeft = includeEqual ? keys[i] <= pivot : keys[i] < pivot;
+        size_t target = toLeft ? left++ : --right;
+        scratchKeys[target] = keys[i];
+        scratchValues[target] = values[i];
+    }
+    std::memcpy(keys, scratchKeys, n * sizeof(uint64_t));
+    std::memcpy(values, scratchValues, n * sizeof(uint64_t));
+    return left;
+}
+
+
+/**
+ * @brief Проверяет, есть ли среди ключей максимальное значение, которым векторные ядра дополняют неполные регистры.
+ * В этом редком случае (NaN с полной мантиссой) блок сортируется скалярно, чтобы дополнение не смешалось с данными.
+ */
+bool simdHasPaddingKey(const uint64_t* keys, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (keys[i] == UINT64_MAX) return true;
+    }
+    return false;
+}
+
+
+#ifdef SORT_BENCH_HAVE_X86_SIMD
+
+/**
+ * @brief Маска дорожек AVX-512, в номере которых установлен бит bit (bit = 1, 2 или 4).
+ */
+inline uint8_t simdLaneBitsAvx512(unsigned bit) {
+    return bit == 1 ? 0xAA : (bit == 2 ? 0xCC : 0xF0);
+}
+
+
+/**
+ * @brief Переставляет дорожки регистра AVX-512: дорожка l получает значение дорожки l ^ stride.
+ */
+SORT_BENCH_TARGET("avx512f")
+inline __m512i simdXorPermuteAvx512(__m512i v, unsigned stride) {
+    switch (stride) {
+        case 1: return _mm512_maskz_permutexvar_epi64(0xFF, _mm512_set_epi64(6, 7, 4, 5, 2, 3, 0, 1), v);
+        case 2: return _mm512_maskz_permutexvar_epi64(0xFF, _mm512_set_epi64(5, 4, 7, 6, 1, 0, 3, 2), v);
+        default: return _mm512_maskz_permutexvar_epi64(0xFF, _mm512_set_epi64(3, 2, 1, 0, 7, 6, 5, 4), v);
+    }
+}
+
+
+/**
+ * @brief Битоническая сеть сортировки по (registers * 8) парам в регистрах AVX-512.
+ * Сравнения на расстоянии >= 8 выполняются между регистрами, на меньших - перестановкой дорожек внутри регистра;
+ * значения переставляются теми же масками, что и ключи.
+ */
+SORT_BENCH_TARGET("avx512f")
+void simdBitonicNetworkAvx512(__m512i* keys, __m512i* values, unsigned registers) {
+    const unsigned lanes = 8;
+    unsigned total = registers * lanes;
+    for (unsigned size = 2; size <= total; size <<= 1) {
+        for (unsigned stride = size >> 1; stride > 0; stride >>= 1) {
+            if (stride >= lanes) {
+                unsigned registerStride = stride / lanes;
+                for (unsigned r = 0; r < registers; ++r) {
+                    if (r & registerStride) continue;
+                    unsigned other = r | registerStride;
+                    bool ascending = ((r * lanes) & size) == 0;
+                    __mmask8 exchange = ascending ? _mm512_cmplt_epu64_mask(keys[other], keys[r])
+                                                  : _mm512_cmplt_epu64_mask(keys[r], keys[other]);
+                    __m512i lowKeys = _mm512_mask_mov_epi64(keys[r], exchange, keys[other]);
+                    __m512i lowValues = _mm512_mask_mov_epi64(values[r], exchange, values[other]);
+                    keys[other] = _mm512_mask_mov_epi64(keys[other], exchange, keys[r]);
+                    values[other] = _mm512_mask_mov_epi64(values[other], exchange, values[r]);
+                    keys[r] = lowKeys;
+                    values[r] = lowValues;
+                }
+            } else {
+                uint8_t lowerLanes = static_cast<uint8_t>(~simdLaneBitsAvx512(stride));
+                for (unsigned r = 0; r < registers; ++r) {
+                    uint8_t descending = size < lanes ? simdLaneBitsAvx512(size) : (((r * lanes) & size) ? 0xFF : 0x00);
+                    __mmask8 takeMin = static_cast<__mmask8>(lowerLanes ^ descending);
+                    __m512i partnerKeys = simdXorPermuteAvx512(keys[r], stride);
+                    __m512i partnerValues = simdXorPermuteAvx512(values[r], stride);
+                    __mmask8 partnerLess = _mm512_cmplt_epu64_mask(partnerKeys, keys[r]);
+                    __mmask8 partnerGreater = _mm512_cmplt_epu64_mask(keys[r], partnerKeys);
+                    __mmask8 take = static_cast<__mmask8>((partnerLess & takeMin) | (partnerGreater & ~takeMin));
+                    keys[r] = _mm512_mask_mov_epi64(keys[r], take, partnerKeys);
+                    values[r] = _mm512_mask_mov_epi64(values[r], take, partnerValues);
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Сортирует до 64 пар битонической сетью AVX-512 (неполные регистры дополняются ключом UINT64_MAX).
+ */
+SORT_BENCH_TARGET("avx512f")
+void simdSortSmallAvx512(uint64_t* keys, uint64_t* values, size_t n) {
+    if (n < 2) return;
+    unsigned registers = 1;
+    while (registers * 8 < n) registers <<= 1;
+    if (n != registers * 8 && simdHasPaddingKey(keys, n)) {
+        simdInsertionSortScalar(keys, values, n);
+        return;
+    }
+    __m512i keyRegisters[8];
+    __m512i valueRegisters[8];
+    __m512i padding = _mm512_set1_epi64(-1);
+    for (unsigned r = 0; r < registers; ++r) {
+        size_t begin = r * 8;
+        size_t count = begin < n ? std::min<size_t>(8, n - begin) : 0;
+        __mmask8 mask = static_cast<__mmask8>((1u << count) - 1);
+        keyRegisters[r] = count ? _mm512_mask_loadu_epi64(padding, mask, keys + begin) : padding;
+        valueRegisters[r] = count ? _mm512_maskz_loadu_epi64(mask, values + begin) : _mm512_setzero_si512();
+    }
+    simdBitonicNetworkAvx512(keyRegisters, valueRegisters, registers);
+    for (unsigned r = 0; r < registers && r * 8 < n; ++r) {
+        size_t begin = r * 8;
+        __mmask8 mask = static_cast<__mmask8>((1u << std::min<size_t>(8, n - begin)) - 1);
+        _mm512_mask_storeu_epi64(keys + begin, mask, keyRegisters[r]);
+        _mm512_mask_storeu_epi64(values + begin, mask, valueRegisters[r]);
+    }
+}
+
+
+/**
+ * @brief Векторное разбиение пар по 8 ключей за шаг: маска сравнения с опорным ключом и
+ * _mm512_mask_compressstoreu_epi64 упаковывают левую и правую части во временный буфер с двух концов.
+ * @return Количество ключей < pivot (или <= pivot при includeEqual), они оказываются в начале.
+ */
+SORT_BENCH_TARGET("avx512f,popcnt")
+size_t simdPartitionAvx512(uint64_t* keys, uint64_t* values, size_t n, uint64_t pivot, bool includeEqual,
+                           uint64_t* scratchKeys, uint64_t* scratchValues) {
+    __m512i pivotVector = _mm512_set1_epi64(static_cast<long long>(pivot));
+    size_t left = 0;
+    size_t right = n;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i k = _mm512_loadu_si512(keys + i);
+        __m512i v = _mm512_loadu_si512(values + i);
+        __mmask8 toLeft = includeEqual ? _mm512_cmple_epu64_mask(k, pivotVector) : _mm512_cmplt_epu64_mask(k, pivotVector);
+        unsigned leftCount = static_cast<unsigned>(_mm_popcnt_u32(toLeft));
+        _mm512_mask_compressstoreu_epi64(scratchKeys + left, toLeft, k);
+        _mm512_mask_compressstoreu_epi64(scratchValues + left, toLeft, v);
+        right -= 8 - leftCount;
+        _mm512_mask_compressstoreu_epi64(scratchKeys + right, static_cast<__mmask8>(~toLeft), k);
+        _mm512_mask_compressstoreu_epi64(scratchValues + right, static_cast<__mmask8>(~toLeft), v);
+        left += leftCount;
+    }
+    for (; i < n; ++i) {
+        bool toLeft = includeEqual ? keys[i] <= pivot : keys[i] < pivot;
+        size_t target = toLeft ? left++ : --right;
+        scratchKeys[target] = keys[i];
+        scratchValues[target] = values[i];
+    }
+    std::memcpy(keys, scratchKeys, n * sizeof(uint64_t));
+    std::memcpy(values, scratchValues, n * sizeof(uint64_t));
+    return left;
+}
+
+
+/**
+ * @brief Маска дорожек AVX2 (по 64 бита), в номере которых установлен бит bit (bit = 1 или 2).
+ */
+SORT_BENCH_TARGET("avx2")
+inline __m256i simdLaneBitsAvx2(unsigned bit) {
+    return bit == 1 ? _mm256_set_epi64x(-1, 0, -1, 0) : _mm256_set_epi64x(-1, -1, 0, 0);
+}
+
+
+/**
+ * @brief Переставляет дорожки регистра AVX2: дорожка l получает значение дорожки l ^ stride.
+ */
+SORT_BENCH_TARGET("avx2")
+inline __m256i simdXorPermuteAvx2(__m256i v, unsigned stride) {
+    return stride == 1 ? _mm256_permute4x64_epi64(v, 0xB1) : _mm256_permute4x64_epi64(v, 0x4E);
+}
+
+
+/**
+ * @brief Битоническая сеть сортировки по (registers * 4) парам в регистрах AVX2.
+ * В AVX2 нет беззнакового сравнения 64-битных чисел, поэтому ключи хранятся в регистрах
+ * со смещением (инвертированным старшим битом) и сравниваются знаково.
+ */
+SORT_BENCH_TARGET("avx2")
+void simdBitonicNetworkAvx2(__m256i* keys, __m256i* values, unsigned registers) {
+    const unsigned lanes = 4;
+    unsigned total = registers * lanes;
+    for (unsigned size = 2; size <= total; size <<= 1) {
+        for (unsigned stride = size >> 1; stride > 0; stride >>= 1) {
+            if (stride >= lanes) {
+                unsigned registerStride = stride / lanes;
+                for (unsigned r = 0; r < registers; ++r) {
+                    if (r & registerStride) continue;
+                    unsigned other = r | registerStride;
+                    bool ascending = ((r * lanes) & size) == 0;
+                    __m256i exchange = ascending ? _mm256_cmpgt_epi64(keys[r], keys[other])
+                                                 : _mm256_cmpgt_epi64(keys[other], keys[r]);
+                    __m256i lowKeys = _mm256_blendv_epi8(keys[r], keys[other], exchange);
+                    __m256i lowValues = _mm256_blendv_epi8(values[r], values[other], exchange);
+                    keys[other] = _mm256_blendv_epi8(keys[other], keys[r], exchange);
+                    values[other] = _mm256_blendv_epi8(values[other], values[r], exchange);
+                    keys[r] = lowKeys;
+                    values[r] = lowValues;
+                }
+            } else {
+                __m256i allLanes = _mm256_set1_epi64x(-1);
+                __m256i lowerLanes = _mm256_xor_si256(simdLaneBitsAvx2(stride), allLanes);
+                for (unsigned r = 0; r < registers; ++r) {
+                    __m256i descending = size < lanes ? simdLaneBitsAvx2(size)
+                                                      : (((r * lanes) & size) ? allLanes : _mm256_setzero_si256());
+                    __m256i takeMin = _mm256_xor_si256(lowerLanes, descending);
+                    __m256i partnerKeys = simdXorPermuteAvx2(keys[r], stride);
+                    __m256i partnerValues = simdXorPermuteAvx2(values[r], stride);
+                    __m256i partnerLess = _mm256_cmpgt_epi64(keys[r], partnerKeys);
+                    __m256i partnerGreater = _mm256_cmpgt_epi64(partnerKeys, keys[r]);
+                    __m256i take = _mm256_or_si256(_mm256_and_si256(partnerLess, takeMin),
+                                                   _mm256_andnot_si256(takeMin, partnerGreater));
+                    keys[r] = _mm256_blendv_epi8(keys[r], partnerKeys, take);
+                    values[r] = _mm256_blendv_epi8(values[r], partnerValues, take);
+                }
+            }
+        }
+    }
+}
+
+
+/**
+ * @brief Маска первых count дорожек AVX2 (для маскированных загрузок и записей).
+ */
+SORT_BENCH_TARGET("avx2")
+inline __m256i simdFirstLanesAvx2(size_t count) {
+    __m256i laneIndex = _mm256_set_epi64x(3, 2, 1, 0);
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(count)), laneIndex);
+}
+
+
+/**
+ * @brief Сортирует до 32 пар битонической сетью AVX2 (неполные регистры дополняются ключом UINT64_MAX).
+ */
+SORT_BENCH_TARGET("avx2")
+void simdSortSmallAvx2(uint64_t* keys, uint64_t* values, size_t n) {
+    if (n < 2) return;
+    unsigned registers = 1;
+    while (registers * 4 < n) registers <<= 1;
+    if (n != registers * 4 && simdHasPaddingKey(keys, n)) {
+        simdInsertionSortScalar(keys, values, n);
+        return;
+    }
+    __m256i keyRegisters[8];
+    __m256i valueRegisters[8];
+    __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+    __m256i padding = _mm256_set1_epi64x(INT64_MAX);   // UINT64_MAX после смещения
+    for (unsigned r = 0; r < registers; ++r) {
+        size_t begin = r * 4;
+        size_t count = begin < n ? std::min<size_t>(4, n - begin) : 0;
+        if (count == 0) {
+            keyRegisters[r] = padding;
+            valueRegisters[r] = _mm256_setzero_si256();
+            continue;
+        }
+        __m256i mask = simdFirstLanesAvx2(count);
+        __m256i k = _mm256_maskload_epi64(reinterpret_cast<const long long*>(keys + begin), mask);
+        keyRegisters[r] = _mm256_blendv_epi8(padding, _mm256_xor_si256(k, signBit), mask);
+        valueRegisters[r] = _mm256_maskload_epi64(reinterpret_cast<const long long*>(values + begin), mask);
+    }
+    simdBitonicNetworkAvx2(keyRegisters, valueRegisters, registers);
+    for (unsigned r = 0; r < registers && r * 4 < n; ++r) {
+        size_t begin = r * 4;
+        __m256i mask = simdFirstLanesAvx2(std::min<size_t>(4, n - begin));
+        _mm256_maskstore_epi64(reinterpret_cast<long long*>(keys + begin), mask, _mm256_xor_si256(keyRegisters[r], signBit));
+        _mm256_maskstore_epi64(reinterpret_cast<long long*>(values + begin), mask, valueRegisters[r]);
+    }
+}
+
+
+/**
+ * @brief Таблица перестановок 32-битных элементов для упаковки выбранных 64-битных дорожек AVX2 в начало регистра.
+ */
+const std::array<std::array<int32_t, 8>, 16>& simdCompressTableAvx2() {
+    static const std::array<std::array<int32_t, 8>, 16> table = []() {
+        std::array<std::array<int32_t, 8>, 16> result{};
+        for (unsigned mask = 0; mask < 16; ++mask) {
+            unsigned position = 0;
+            for (unsigned pass = 0; pass < 2; ++pass) {
+                for (unsigned lane = 0; lane < 4; ++lane) {
+                    bool selected = (mask >> lane) & 1;
+                    if (selected == (pass == 0)) {
+                        result[mask][2 * position] = static_cast<int32_t>(2 * lane);
+                        result[mask][2 * position + 1] = static_cast<int32_t>(2 * lane + 1);
+                        ++position;
+                    }
+                }
+            }
+        }
+        return result;
+    }();
+    return table;
+}
+
+
+/**
+ * @brief Векторное разбиение пар по 4 ключа за шаг (AVX2): выбранные дорожки упаковываются перестановкой
+ * из simdCompressTableAvx2 и записываются маскированной записью в начало или конец временного буфера.
+ * @return Количество ключей < pivot (или <= pivot при includeEqual), они оказываются в начале.
+ */
+SORT_BENCH_TARGET("avx2,popcnt")
+size_t simdPartitionAvx2(uint64_t* keys, uint64_t* values, size_t n, uint64_t pivot, bool includeEqual,
+                         uint64_t* scratchKeys, uint64_t* scratchValues) {
+    const auto& compress = simdCompressTableAvx2();
+    __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+    __m256i pivotVector = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(pivot)), signBit);
+    size_t left = 0;
+    size_t right = n;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i biased = _mm256_xor_si256(k, signBit);
+        __m256i greater = _mm256_cmpgt_epi64(biased, pivotVector);
+        __m256i less = _mm256_cmpgt_epi64(pivotVector, biased);
+        int leftMask = _mm256_movemask_pd(_mm256_castsi256_pd(
+            includeEqual ? _mm256_xor_si256(greater, _mm256_set1_epi64x(-1)) : less));
+        unsigned leftCount = static_cast<unsigned>(_mm_popcnt_u32(static_cast<unsigned>(leftMask)));
+        unsigned rightCount = 4 - leftCount;
+
+        __m256i leftPermutation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(compress[leftMask].data()));
+        __m256i rightPermutation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(compress[~leftMask & 0xF].data()));
+        __m256i leftStoreMask = simdFirstLanesAvx2(leftCount);
+        __m256i rightStoreMask = simdFirstLanesAvx2(rightCount);
+        right -= rightCount;
+        _mm256_maskstore_epi64(reinterpret_cast<long long*>(scratchKeys + left), leftStoreMask,
+                               _mm256_permutevar8x32_epi32(k, leftPermutation));
+        _mm256_maskstore_epi64(reinterpret_cast<long long*>(scratchValues + left), leftStoreMask,
+                               _mm256_permutevar8x32_epi32(v, leftPermutation));
+        _mm256_maskstore_epi64(reinterpret_cast<long long*>(scratchKeys + right), rightStoreMask,
+                               _mm256_permutevar8x32_epi32(k, rightPermutation));
+        _mm256_maskstore_epi64(reinterpret_cast<long long*>(scratchValues + right), rightStoreMask,
+                               _mm256_permutevar8x32_epi32(v, rightPermutation));
+        left += leftCount;
+    }
+    for (; i < n; ++i) {
+        bool toLeft = includeEqual ? keys[i] <= pivot : keys[i] < pivot;
+        size_t target = toLeft ? left++ : --right;
+        scratchKeys[target] = keys[i];
+        scratchValues[target] = values[i];
+    }
+    std::memcpy(keys, scratchKeys, n * sizeof(uint64_t));
+    std::memcpy(values, scratchValues, n * sizeof(uint64_t));
+    return left;
+}
+
+#endif // SORT_BENCH_HAVE_X86_SIMD
+
+
+/**
+ * @brief Ядро SIMD-сортировки: базовый случай (сеть сортировки) и шаг разбиения для одного набора инструкций.
+ */
+struct SimdSortKernel {
+    size_t baseCaseSize;   ///< Максимальный размер диапазона, который сортирует sortSmall
+    void (*sortSmall)(uint64_t* keys, uint64_t* values, size_t n);
+    size_t (*partition)(uint64_t* keys, uint64_t* values, size_t n, uint64_t pivot, bool includeEqual,
+                        uint64_t* scratchKeys, uint64_t* scratchValues);
+};
+
+
+/**
+ * @brief Возвращает ядро для заданного набора инструкций (без проверки поддержки процессором).
+ */
+SimdSortKernel simdSortKernel(SimdLevel level) {
+#ifdef SORT_BENCH_HAVE_X86_SIMD
+    if (level == SimdLevel::Avx512) return {64, simdSortSmallAvx512, simdPartitionAvx512};
+    if (level == SimdLevel::Avx2) return {32, simdSortSmallAvx2, simdPartitionAvx2};
+#else
+    (void)level;
+#endif
+    return {16, simdInsertionSortScalar, simdPartitionScalar};
+}
+
+
+/**
+ * @brief Быстрая сортировка пар (ключ, значение) с векторными разбиением и базовым случаем.
+ * Опорный ключ - медиана из трех. Если ни один ключ не меньше опорного, выполняется разбиение
+ * по "<=": левая часть тогда состоит из равных ключей и дальше не сортируется.
+ * При исчерпании глубины рекурсии диапазон досортировывается std::sort по парам.
+ */
+void simdQuickSort(uint64_t* keys, uint64_t* values, size_t n, uint64_t* scratchKeys, uint64_t* scratchValues,
+                   const SimdSortKernel& kernel, int depthLimit) {
+    while (n > kernel.baseCaseSize) {
+        if (depthLimit-- == 0) {
+            std::vector<std::pair<uint64_t, uint64_t>> pairs(n);
+            for (size_t i = 0; i < n; ++i) pairs[i] = {keys[i], values[i]};
+            std::sort(pairs.begin(), pairs.end());
+            for (size_t i = 0; i < n; ++i) {
+                keys[i] = pairs[i].first;
+                values[i] = pairs[i].second;
+            }
+            return;
+        }
+        uint64_t a = keys[0];
+        uint64_t b = keys[n / 2];
+        uint64_t c = keys[n - 1];
+        uint64_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        size_t left = kernel.partition(keys, values, n, pivot, false, scratchKeys, scratchValues);
+        if (left == 0) {
+            size_t equal = kernel.partition(keys, values, n, pivot, true, scratchKeys, scratchValues);
+            keys += equal;
+            values += equal;
+            n -= equal;
+            continue;
+        }
+        if (left < n - left) {
+            simdQuickSort(keys, values, left, scratchKeys, scratchValues, kernel, depthLimit);
+            keys += left;
+            values += left;
+            n -= left;
+        } else {
+            simdQuickSort(keys + left, values + left, n - left, scratchKeys, scratchValues, kernel, depthLimit);
+            n = left;
+        }
+    }
+    kernel.sortSmall(keys, values, n);
+}
+
+
+/**
+ * @brief Сортирует пары (ключ, значение) по возрастанию ключа SIMD-ядром заданного уровня (неустойчиво).
+ * @param keys Ключи.
+ * @param values Значения, переставляемые вместе с ключами (того же размера).
+ * @param level Набор инструкций; должен поддерживаться процессором (см. detectSimdLevel()).
+ */
+void simdSortKeys(std::vector<uint64_t>& keys, std::vector<uint64_t>& values, SimdLevel level) {
+    size_t n = keys.size();
+    if (n < 2) return;
+    std::vector<uint64_t> scratchKeys(n);
+    std::vector<uint64_t> scratchValues(n);
+    int depthLimit = 0;
+    for (size_t m = n; m > 1; m >>= 1) depthLimit += 2;
+    simdQuickSort(keys.data(), values.data(), n, scratchKeys.data(), scratchValues.data(), simdSortKernel(level), depthLimit);
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service SIMD-ядром по извлеченным ключам.
+ * Ключ - sortableDoubleBits(cost) с индексом записи; записи с равной стоимостью досортировываются
+ * по предоплате и названию, поэтому результат совпадает с Service::operator<.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param level Набор инструкций (по умолчанию - лучший из поддерживаемых).
+ */
+void simdSort(std::vector<Service>& arr, SimdLevel level = detectSimdLevel()) {
+    size_t n = arr.size();
+    if (n < 2) return;
+
+    std::vector<uint64_t> keys(n);
+    std::vector<uint64_t> indices(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = sortableDoubleBits(arr[i].cost);
+        indices[i] = i;
+    }
+    simdSortKeys(keys, indices, level);
+
+    size_t runStart = 0;
+    for (size_t i = 1; i <= n; ++i) {
+        if (i == n || keys[i] != keys[runStart]) {
+            if (i - runStart > 1) {
+                std::sort(indices.begin() + runStart, indices.begin() + i, [&arr](uint64_t a, uint64_t b) {
+                    if (arr[a].prepayment != arr[b].prepayment) return arr[a].prepayment < arr[b].prepayment;
+                    return arr[a].name < arr[b].name;
+                });
+            }
+            runStart = i;
+        }
+    }
+
+    std::vector<Service> sorted;
+    sorted.reserve(n);
+    for (uint64_t index : indices) {
+        sorted.push_back(std::move(arr[index]));
+    }
+    arr.swap(sorted);
+}
+
+
+#ifdef SORT_BENCH_HAVE_CUDA
+/**
+ * @brief Сортирует вектор объектов Service на GPU (gpuSortKeys, сборка с SORT_BENCH_WITH_CUDA).
+ * На устройство передаются только ключи стоимости и предоплаты (sortableDoubleBits), обратно -
+ * перестановка индексов. Записи с равными ключами досортировываются по названию на хосте,
+ * поэтому результат совпадает с Service::operator<.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param timings Время этапов (nullptr - не нужно).
+ * @throws std::runtime_error При ошибке CUDA.
+ */
+void gpuSort(std::vector<Service>& arr, GpuSortTimings* timings = nullptr) {
+    GpuSortTimings stageTimings;
+    size_t n = arr.size();
+    if (n >= 2) {
+        auto extractStart = std::chrono::steady_clock::now();
+        std::vector<uint64_t> primary(n);
+        std::vector<uint64_t> secondary(n);
+        for (size_t i = 0; i < n; ++i) {
+            primary[i] = sortableDoubleBits(arr[i].cost);
+            secondary[i] = sortableDoubleBits(arr[i].prepayment);
+        }
+        std::vector<uint32_t> permutation(n);
+        auto extractEnd = std::chrono::steady_clock::now();
+        stageTimings.extractMs = std::chrono::duration<double, std::milli>(extractEnd - extractStart).count();
+
+        gpuSortKeys(primary.data(), secondary.data(), n, permutation.data(), stageTimings);
+
+        auto permuteStart = std::chrono::steady_clock::now();
+        size_t runStart = 0;
+        for (size_t i = 1; i <= n; ++i) {
+            if (i == n || primary[permutation[i]] != primary[permutation[runStart]]
+                       || secondary[permutation[i]] != secondary[permutation[runStart]]) {
+                if (i - runStart > 1) {
+                    std::sort(permutation.begin() + runStart, permutation.begin() + i, [&arr](uint32_t a, uint32_t b) {
+                        return arr[a].name < arr[b].name;
+                    });
+                }
+                runStart = i;
+            }
+        }
+        std::vector<Service> sorted;
+        sorted.reserve(n);
+        for (uint32_t index : permutation) {
+            sorted.push_back(std::move(arr[index]));
+        }
+        arr.swap(sorted);
+        stageTimings.permuteMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - permuteStart).count();
+    }
+    if (timings) *timings = stageTimings;
+}
+#endif
+
+
+/**
+ * @brief Размер диапазона, ниже которого гибридная сортировка переходит на сортировку вставками.
+ */
+const size_t HYBRID_INSERTION_SORT_THRESHOLD = 24;
+
+/**
+ * @brief Размер диапазона, начиная с которого опорный элемент pdqsort выбирается псевдомедианой из девяти.
+ */
+const size_t PDQ_NINTHER_THRESHOLD = 128;
+
+/**
+ * @brief Предельное число перемещений в сортировке вставками, после которого диапазон считается неупорядоченным.
+ */
+const size_t PDQ_PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+/**
+ * @brief Минимальная длина серии в режиме слияния естественных серий; более короткие серии дополняются вставками.
+ */
+const size_t HYBRID_MIN_RUN = 32;
+
+/**
+ * @brief Средняя длина естественной серии, начиная с которой вход сортируется слиянием серий, а не pdqsort.
+ */
+const size_t HYBRID_MIN_AVERAGE_RUN = 16;
+
+
+/**
+ * @brief Сортировка вставками диапазона [first, last).
+ * @param unguarded Если true, перед first гарантированно есть элемент не больше всех элементов диапазона,
+ *                  и проверка границы во внутреннем цикле не нужна.
+ */
+template<typename Iter, typename Compare>
+void hybridInsertionSort(Iter first, Iter last, Compare comp, bool unguarded = false) {
+    if (first == last) return;
+    for (Iter current = first + 1; current != last; ++current) {
+        Iter sift = current;
+        Iter previous = current - 1;
+        if (comp(*sift, *previous)) {
+            auto value = std::move(*sift);
+            do {
+                *sift-- = std::move(*previous);
+            } while ((unguarded || sift != first) && comp(value, *--previous));
+            *sift = std::move(value);
+        }
+    }
+}
+
+
+/**
+ * @brief Сортировка вставками, которая прерывается, если перемещений больше PDQ_PARTIAL_INSERTION_SORT_LIMIT.
+ * @return True, если диапазон отсортирован до конца.
+ */
+template<typename Iter, typename Compare>
+bool pdqPartialInsertionSort(Iter first, Iter last, Compare comp) {
+    if (first == last) return true;
+    size_t moved = 0;
+    for (Iter current = first + 1; current != last; ++current) {
+        Iter sift = current;
+        Iter previous = current - 1;
+        if (comp(*sift, *previous)) {
+            auto value = std::move(*sift);
+            do {
+                *sift-- = std::move(*previous);
+            } while (sift != first && comp(value, *--previous));
+            *sift = std::move(value);
+            moved += current - sift;
+        }
+        if (moved > PDQ_PARTIAL_INSERTION_SORT_LIMIT) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Упорядочивает три элемента (a <= b <= c).
+ */
+template<typename Iter, typename Compare>
+void pdqSort3(Iter a, Iter b, Iter c, Compare comp) {
+    if (comp(*b, *a)) std::iter_swap(a, b);
+    if (comp(*c, *b)) std::iter_swap(b, c);
+    if (comp(*b, *a)) std::iter_swap(a, b);
+}
+
+
+/**
+ * @brief Разбиение вокруг опорного элемента *first: слева - строго меньшие, справа - не меньшие.
+ * @return Позиция опорного элемента и признак того, что диапазон уже был разбит (не понадобилось ни одного обмена).
+ */
+template<typename Iter, typename Compare>
+std::pair<Iter, bool> pdqPartitionRight(Iter begin, Iter end, Compare comp) {
+    auto pivot = std::move(*begin);
+    Iter first = begin;
+    Iter last = end;
+    // Медиана из трех гарантирует существование элемента >= pivot справа.
+    while (comp(*++first, pivot)) {}
+    if (first - 1 == begin) {
+        while (first < last && !comp(*--last, pivot)) {}
+    } else {
+        while (!comp(*--last, pivot)) {}
+    }
+    bool alreadyPartitioned = first >= last;
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(*++first, pivot)) {}
+        while (!comp(*--last, pivot)) {}
+    }
+    Iter pivotPosition = first - 1;
+    *begin = std::move(*pivotPosition);
+    *pivotPosition = std::move(pivot);
+    return {pivotPosition, alreadyPartitioned};
+}
+
+
+/**
+ * @brief Разбиение, при котором равные опорному элементы попадают влево.
+ * Используется, когда опорный элемент равен элементу перед диапазоном: все равные ему
+ * элементы уже на своих местах, и их не нужно сортировать повторно (много одинаковых ключей).
+ * @return Позиция опорного элемента.
+ */
+template<typename Iter, typename Compare>
+Iter pdqPartitionLeft(Iter begin, Iter end, Compare comp) {
+    auto pivot = std::move(*begin);
+    Iter first = begin;
+    Iter last = end;
+    while (comp(pivot, *--last)) {}
+    if (last + 1 == end) {
+        while (first < last && !comp(pivot, *++first)) {}
+    } else {
+        while (!comp(pivot, *++first)) {}
+    }
+    while (first < last) {
+        std::iter_swap(first, last);
+        while (comp(pivot, *--last)) {}
+        while (!comp(pivot, *++first)) {}
+    }
+    Iter pivotPosition = last;
+    *begin = std::move(*pivotPosition);
+    *pivotPosition = std::move(pivot);
+    return pivotPosition;
+}
+
+
+/**
+ * @brief Основной цикл pattern-defeating quicksort.
+ * @param badAllowed Сколько сильно несбалансированных разбиений допускается до перехода на пирамидальную сортировку.
+ * @param leftmost True, если перед диапазоном нет элементов (иначе элемент *(begin - 1) не больше всех в диапазоне).
+ */
+template<typename Iter, typename Compare>
+void pdqSortLoop(Iter begin, Iter end, Compare comp, int badAllowed, bool leftmost = true) {
+    while (true) {
+        size_t size = end - begin;
+        if (size < HYBRID_INSERTION_SORT_THRESHOLD) {
+            hybridInsertionSort(begin, end, comp, !leftmost);
+            return;
+        }
+
+        size_t half = size / 2;
+        if (size > PDQ_NINTHER_THRESHOLD) {
+            pdqSort3(begin, begin + half, end - 1, comp);
+            pdqSort3(begin + 1, begin + (half - 1), end - 2, comp);
+            pdqSort3(begin + 2, begin + (half + 1), end - 3, comp);
+            pdqSort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+            std::iter_swap(begin, begin + half);
+        } else {
+            pdqSort3(begin + half, begin, end - 1, comp);
+        }
+
+        if (!leftmost && !comp(*(begin - 1), *begin)) {
+            begin = pdqPartitionLeft(begin, end, comp) + 1;
+            continue;
+        }
+
+        auto [pivotPosition, alreadyPartitioned] = pdqPartitionRight(begin, end, comp);
+        size_t leftSize = pivotPosition - begin;
+        size_t rightSize = end - (pivotPosition + 1);
+
+        if (leftSize < size / 8 || rightSize < size / 8) {
+            if (--badAllowed == 0) {
+                std::make_heap(begin, end, comp);
+                std::sort_heap(begin, end, comp);
+                return;
+            }
+            // Перемешивание разрушает паттерны, дающие плохие опорные элементы.
+            if (leftSize >= HYBRID_INSERTION_SORT_THRESHOLD) {
+                std::iter_swap(begin, begin + leftSize / 4);
+                std::iter_swap(pivotPosition - 1, pivotPosition - leftSize / 4);
+                if (leftSize > PDQ_NINTHER_THRESHOLD) {
+                    std::iter_swap(begin + 1, begin + (leftSize / 4 + 1));
+                    std::iter_swap(begin + 2, begin + (leftSize / 4 + 2));
+                    std::iter_swap(pivotPosition - 2, pivotPosition - (leftSize / 4 + 1));
+                    std::iter_swap(pivotPosition - 3, pivotPosition - (leftSize / 4 + 2));
+                }
+            }
+            if (rightSize >= HYBRID_INSERTION_SORT_THRESHOLD) {
+                std::iter_swap(pivotPosition + 1, pivotPosition + (1 + rightSize / 4));
+                std::iter_swap(end - 1, end - rightSize / 4);
+                if (rightSize > PDQ_NINTHER_THRESHOLD) {
+                    std::iter_swap(pivotPosition + 2, pivotPosition + (2 + rightSize / 4));
+                    std::iter_swap(pivotPosition + 3, pivotPosition + (3 + rightSize / 4));
+                    std::iter_swap(end - 2, end - (1 + rightSize / 4));
+                    std::iter_swap(end - 3, end - (2 + rightSize / 4));
+                }
+            }
+        } else if (alreadyPartitioned && pdqPartialInsertionSort(begin, pivotPosition, comp)
+                   && pdqPartialInsertionSort(pivotPosition + 1, end, comp)) {
+            return;
+        }
+
+        pdqSortLoop(begin, pivotPosition, comp, badAllowed, leftmost);
+        begin = pivotPosition + 1;
+        leftmost = false;
+    }
+}
+
+
+/**
+ * @brief Pattern-defeating quicksort (неустойчивая).
+ * Быстрая сортировка с медианой из трех/девяти, отдельной обработкой равных ключей,
+ * досрочным выходом на уже разбитых диапазонах и переходом на пирамидальную сортировку
+ * при вырожденных разбиениях (гарантия O(n log n)).
+ */
+template<typename Iter, typename Compare>
+void pdqSort(Iter first, Iter last, Compare comp) {
+    size_t n = last - first;
+    if (n < 2) return;
+    int log2n = 0;
+    while (n >>= 1) ++log2n;
+    pdqSortLoop(first, last, comp, log2n);
+}
+
+
+/**
+ * @brief Возвращает конец естественной серии, начинающейся в first.
+ * Строго убывающая серия разворачивается, поэтому на выходе [first, результат) всегда упорядочен по возрастанию.
+ */
+template<typename Iter, typename Compare>
+Iter extendNaturalRun(Iter first, Iter last, Compare comp) {
+    Iter runEnd = first + 1;
+    if (runEnd == last) return runEnd;
+    if (comp(*runEnd, *first)) {
+        while (runEnd + 1 != last && comp(*(runEnd + 1), *runEnd)) ++runEnd;
+        ++runEnd;
+        std::reverse(first, runEnd);
+    } else {
+        while (runEnd + 1 != last && !comp(*(runEnd + 1), *runEnd)) ++runEnd;
+        ++runEnd;
+    }
+    return runEnd;
+}
+
+
+/**
+ * @brief Сливает соседние отсортированные диапазоны [first, mid) и [mid, last) через буфер.
+ * Уже стоящие на месте префикс левой и суффикс правой части отсекаются бинарным поиском,
+ * в буфер переносится меньшая из оставшихся частей.
+ */
+template<typename Iter, typename Compare, typename Buffer>
+void mergeAdjacentRuns(Iter first, Iter mid, Iter last, Compare comp, Buffer& buffer) {
+    if (first == mid || mid == last || !comp(*mid, *(mid - 1))) return;
+    first = std::upper_bound(first, mid, *mid, comp);
+    last = std::lower_bound(mid, last, *(mid - 1), comp);
+
+    buffer.clear();
+    if (mid - first <= last - mid) {
+        buffer.assign(std::make_move_iterator(first), std::make_move_iterator(mid));
+        auto left = buffer.begin();
+        Iter right = mid;
+        Iter out = first;
+        while (left != buffer.end() && right != last) {
+            *out++ = comp(*right, *left) ? std::move(*right++) : std::move(*left++);
+        }
+        std::move(left, buffer.end(), out);
+    } else {
+        buffer.assign(std::make_move_iterator(mid), std::make_move_iterator(last));
+        auto right = buffer.end();
+        Iter left = mid;
+        Iter out = last;
+        while (right != buffer.begin() && left != first) {
+            *--out = comp(*(right - 1), *(left - 1)) ? std::move(*--left) : std::move(*--right);
+        }
+        std::move_backward(buffer.begin(), right, out);
+    }
+}
+
+
+/**
+ * @brief Глубина узла слияния двух соседних серий в дереве powersort.
+ * Серии [begin, mid) и [mid, end) из n элементов; чем больше значение, тем глубже узел и тем раньше его нужно слить.
+ */
+inline unsigned powersortNodePower(size_t begin, size_t mid, size_t end, size_t n) {
+    uint64_t a = static_cast<uint64_t>(begin) + mid;   // Удвоенная середина левой серии
+    uint64_t b = static_cast<uint64_t>(mid) + end;     // Удвоенная середина правой серии
+    unsigned power = 0;
+    while (true) {
+        ++power;
+        if (a >= n) {
+            a -= n;
+            b -= n;
+        } else if (b >= n) {
+            break;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+    return power;
+}
+
+
+/**
+ * @brief Слияние естественных серий в порядке powersort.
+ * Серии короче HYBRID_MIN_RUN дополняются сортировкой вставками, затем соседние серии сливаются
+ * по стеку с глубинами узлов (близко к оптимальному дереву слияний для данного разбиения на серии).
+ */
+template<typename Iter, typename Compare>
+void naturalMergeSort(Iter first, Iter last, Compare comp) {
+    struct Run {
+        size_t begin;
+        size_t end;
+        unsigned power;
+    };
+    size_t n = last - first;
+    if (n < 2) return;
+    std::vector<typename std::iterator_traits<Iter>::value_type> buffer;
+    std::vector<Run> stack;
+
+    auto nextRun = [&](size_t begin) {
+        size_t end = extendNaturalRun(first + begin, last, comp) - first;
+        if (end - begin < HYBRID_MIN_RUN && end < n) {
+            size_t forcedEnd = std::min(n, begin + HYBRID_MIN_RUN);
+            hybridInsertionSort(first + begin, first + forcedEnd, comp);
+            end = forcedEnd;
+        }
+        return end;
+    };
+
+    Run current{0, nextRun(0), 0};
+    while (current.end < n) {
+        Run next{current.end, nextRun(current.end), 0};
+        unsigned power = powersortNodePower(current.begin, current.end, next.end, n);
+        while (!stack.empty() && stack.back().power > power) {
+            mergeAdjacentRuns(first + stack.back().begin, first + stack.back().end, first + current.end, comp, buffer);
+            current.begin = stack.back().begin;
+            stack.pop_back();
+        }
+        stack.push_back({current.begin, current.end, power});
+        current = next;
+    }
+    while (!stack.empty()) {
+        mergeAdjacentRuns(first + stack.back().begin, first + stack.back().end, first + current.end, comp, buffer);
+        current.begin = stack.back().begin;
+        stack.pop_back();
+    }
+}
+
+
+/**
+ * @brief Адаптивная гибридная сортировка (неустойчивая).
+ * Маленькие диапазоны сортируются вставками. Для остальных один проход считает естественные
+ * (возрастающие или строго убывающие) серии: если их средняя длина не меньше HYBRID_MIN_AVERAGE_RUN
+ * (почти отсортированные или развернутые данные, дописанный в конец хвост), серии сливаются
+ * в порядке powersort, иначе выполняется pdqSort. Подсчет серий прерывается, как только
+ * становится ясно, что их слишком много, поэтому на случайных данных проход почти бесплатен.
+ */
+template<typename Iter, typename Compare>
+void adaptiveSort(Iter first, Iter last, Compare comp) {
+    size_t n = last - first;
+    if (n < HYBRID_INSERTION_SORT_THRESHOLD) {
+        hybridInsertionSort(first, last, comp);
+        return;
+    }
+
+    size_t maxRuns = n / HYBRID_MIN_AVERAGE_RUN;
+    size_t runs = 1;
+    Iter it = first + 1;
+    while (it != last && runs <= maxRuns) {
+        if (comp(*it, *(it - 1))) {
+            while (it != last && comp(*it, *(it - 1))) ++it;
+        } else {
+            while (it != last && !comp(*it, *(it - 1))) ++it;
+        }
+        if (it != last) {
+            // *it открывает новую серию; сравнение начинается со следующего элемента.
+            ++runs;
+            ++it;
+        }
+    }
+
+    if (runs <= maxRuns) {
+        naturalMergeSort(first, last, comp);
+    } else {
+        pdqSort(first, last, comp);
+    }
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service адаптивной гибридной сортировкой (слияние серий / pdqsort).
+ * Порядок совпадает с std::sort по Service::operator<.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+void adaptiveSort(std::vector<Service>& arr) {
+    adaptiveSort(arr.begin(), arr.end(), std::less<Service>());
+}
+
+
+/**
+ * @brief Длина блоков, которые стабильные сортировки слиянием сначала сортируют вставками.
+ */
+const size_t STABLE_SORT_BLOCK = 24;
+
+
+/**
+ * @brief Стабильная сортировка слиянием, которая хранит буфер между вызовами.
+ *
+ * Блоки по STABLE_SORT_BLOCK элементов сортируются вставками, затем сливаются снизу вверх;
+ * перед слиянием в буфер переносится только левая серия, поэтому буфер не больше
+ * самой длинной левой серии (меньше n). Буфер не освобождается после сортировки, и
+ * повторные вызовы на данных того же размера не выделяют память.
+ * @tparam T Тип элементов.
+ */
+template<typename T>
+class StableMergeSorter {
+public:
+    /**
+     * @brief Стабильно сортирует [first, last).
+     * @param comp Предикат "меньше"; равные по нему элементы сохраняют исходный порядок.
+     */
+    template<typename Iter, typename Compare>
+    void sort(Iter first, Iter last, Compare comp) {
+        size_t n = static_cast<size_t>(last - first);
+        for (size_t lo = 0; lo < n; lo += STABLE_SORT_BLOCK) {
+            hybridInsertionSort(first + lo, first + std::min(n, lo + STABLE_SORT_BLOCK), comp);
+        }
+        for (size_t width = STABLE_SORT_BLOCK; width < n; width *= 2) {
+            if (scratch.size() < width) scratch.resize(width);
+            for (size_t lo = 0; lo + width < n; lo += 2 * width) {
+                mergeWithBuffer(first + lo, first + lo + width, first + std::min(n, lo + 2 * width), comp);
+            }
+        }
+    }
+
+    /**
+     * @brief Возвращает текущий размер буфера (элементов).
+     */
+    size_t scratchSize() const { return scratch.size(); }
+
+private:
+    template<typename Iter, typename Compare>
+    void mergeWithBuffer(Iter first, Iter middle, Iter last, Compare comp) {
+        if (!comp(*middle, *(middle - 1))) return;
+        auto buffer = scratch.begin();
+        auto bufferEnd = std::move(first, middle, buffer);
+        Iter out = first;
+        while (buffer != bufferEnd && middle != last) {
+            if (comp(*middle, *buffer)) {
+                *out++ = std::move(*middle++);
+            } else {
+                *out++ = std::move(*buffer++);
+            }
+        }
+        std::move(buffer, bufferEnd, out);
+    }
+
+    std::vector<T> scratch;
+};
+
+
+/**
+ * @brief Стабильно сливает соседние отсортированные диапазоны на месте без выделения памяти (SymMerge).
+ * Диапазоны делятся симметричным бинарным поиском, средняя часть переставляется std::rotate,
+ * и половины сливаются рекурсивно; глубина рекурсии O(log n), сравнений O(m log(n/m + 1)),
+ * перемещений O(n log n) (m и n - длины меньшего и большего диапазонов).
+ */
+template<typename Iter, typename Compare>
+void symMerge(Iter first, Iter middle, Iter last, Compare comp) {
+    if (first == middle || middle == last || !comp(*middle, *(middle - 1))) return;
+    if (middle - first == 1) {
+        Iter position = std::lower_bound(middle, last, *first, comp);
+        std::rotate(first, middle, position);
+        return;
+    }
+    if (last - middle == 1) {
+        Iter position = std::upper_bound(first, middle, *middle, comp);
+        std::rotate(position, middle, last);
+        return;
+    }
+
+    auto half = (last - first) / 2;
+    Iter mid = first + half;
+    auto n = (mid - first) + (middle - first);
+    auto start = middle > mid ? n - (last - first) : 0;
+    auto r = middle > mid ? half : (middle - first);
+    auto p = n - 1;
+    while (start < r) {
+        auto c = (start + r) / 2;
+        if (!comp(*(first + (p - c)), *(first + c))) {
+            start = c + 1;
+        } else {
+            r = c;
+        }
+    }
+    Iter startIt = first + start;
+    Iter endIt = first + (n - start);
+    if (startIt < middle && middle < endIt) std::rotate(startIt, middle, endIt);
+    symMerge(first, startIt, mid, comp);
+    symMerge(mid, endIt, last, comp);
+}
+
+
+/**
+ * @brief Стабильная сортировка слиянием на месте без выделения памяти.
+ * Блоки по STABLE_SORT_BLOCK элементов сортируются вставками и сливаются снизу вверх symMerge.
+ * Время O(n log^2 n): O(log n) проходов слияния по O(n log n) перемещений. Проходы идут циклом,
+ * поэтому дополнительная память - только стек рекурсии symMerge глубиной O(log n).
+ * @param comp Предикат "меньше"; равные по нему элементы сохраняют исходный порядок.
+ */
+template<typename Iter, typename Compare>
+void inPlaceStableSort(Iter first, Iter last, Compare comp) {
+    size_t n = static_cast<size_t>(last - first);
+    for (size_t lo = 0; lo < n; lo += STABLE_SORT_BLOCK) {
+        hybridInsertionSort(first + lo, first + std::min(n, lo + STABLE_SORT_BLOCK), comp);
+    }
+    for (size_t width = STABLE_SORT_BLOCK; width < n; width *= 2) {
+        for (size_t lo = 0; lo + width < n; lo += 2 * width) {
+            symMerge(first + lo, first + lo + width, first + std::min(n, lo + 2 * width), comp);
+        }
+    }
+}
+
+
+/**
+ * @brief Порядок стабильных сортировок: стоимость, затем предоплата; при равенстве обоих сохраняется исходный порядок.
+ */
+using StableSortSpec = SortSpec<SortKey<SortField::Cost>, SortKey<SortField::Prepayment>>;
+
+
+/**
+ * @brief Стабильно сортирует вектор объектов Service по стоимости и предоплате с помощью std::stable_sort.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+void stableStdSort(std::vector<Service>& arr) {
+    std::stable_sort(arr.begin(), arr.end(), StableSortSpec());
+}
+
+
+/**
+ * @brief Стабильно сортирует вектор объектов Service по стоимости и предоплате слиянием с переиспользуемым буфером.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param sorter Сортировщик, буфер которого сохраняется между вызовами.
+ */
+void stableMergeSort(std::vector<Service>& arr, StableMergeSorter<Service>& sorter) {
+    sorter.sort(arr.begin(), arr.end(), StableSortSpec());
+}
+
+
+/**
+ * @brief Стабильно сортирует вектор объектов Service по стоимости и предоплате слиянием на месте
+ * (время O(n log^2 n), стек O(log n), без выделения памяти).
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ */
+void inPlaceStableSort(std::vector<Service>& arr) {
+    inPlaceStableSort(arr.begin(), arr.end(), StableSortSpec());
+}
+
+
+/**
+ * @brief Сравнивает запись из потокового чтения с записью Service в порядке Service::operator<.
+ * Позволяет отбросить запись, не создавая для ее названия std::string.
+ * @param view Прочитанная запись.
+ * @param service Запись, с которой производится сравнение.
+ * @return True, если view "меньше" service.
+ */
+inline bool serviceViewLess(const ServiceView& view, const Service& service) {
+    if (view.cost != service.cost) {
+        return view.cost < service.cost;
+    }
+    if (view.prepayment != service.prepayment) {
+        return view.prepayment < service.prepayment;
+    }
+    return view.name < std::string_view(service.name);
+}
+
+
+/**
+ * @brief Отбирает k наименьших услуг ограниченной кучей размера k.
+ * Куча хранит текущие k лучших записей с наибольшей на вершине; каждая следующая запись
+ * сравнивается с вершиной, и лишь более дешевые заменяют ее. Время O(n log k), память O(k).
+ * @param services Исходные записи (не изменяются).
+ * @param k Количество отбираемых записей.
+ * @return Не более k наименьших записей, упорядоченных по возрастанию.
+ */
+std::vector<Service> topKHeap(const std::vector<Service>& services, size_t k) {
+    std::vector<Service> heap;
+    if (k == 0) return heap;
+    heap.reserve(std::min(k, services.size()));
+    for (const auto& service : services) {
+        if (heap.size() < k) {
+            heap.push_back(service);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (service < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = service;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end());
+    return heap;
+}
+
+
+/**
+ * @brief Оставляет в векторе k наименьших услуг: std::nth_element, затем сортировка первых k.
+ * Время O(n + k log k) в среднем.
+ * @param services Вектор Service (изменяется на месте и усекается до k записей по возрастанию).
+ * @param k Количество отбираемых записей.
+ */
+void topKSelect(std::vector<Service>& services, size_t k) {
+    if (k < services.size()) {
+        std::nth_element(services.begin(), services.begin() + k, services.end());
+        services.resize(k);
+    }
+    std::sort(services.begin(), services.end());
+}
+
+
+/**
+ * @brief Оставляет в векторе k наименьших услуг с помощью std::partial_sort (heap select). Время O(n log k).
+ * @param services Вектор Service (изменяется на месте и усекается до k записей по возрастанию).
+ * @param k Количество отбираемых записей.
+ */
+void topKPartialSort(std::vector<Service>& services, size_t k) {
+    k = std::min(k, services.size());
+    std::partial_sort(services.begin(), services.begin() + k, services.end());
+    services.resize(k);
+}
+
+
+/**
+ * @brief Отбирает k наименьших услуг прямо из CSV-файла, не загружая его целиком.
+ * Файл читается streamServices; ограниченная куча, как в topKHeap, хранит только k записей,
+ * а запись, не меньшая вершины кучи, отбрасывается без копирования названия.
+ * @param filename Путь к CSV-файлу.
+ * @param k Количество отбираемых записей.
+ * @param result Не более k наименьших записей по возрастанию (выходной параметр).
+ * @param blockBytes Размер блока чтения.
+ * @return True, если файл прочитан успешно, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть.
+ */
+bool topKStreaming(const std::string& filename, size_t k, std::vector<Service>& result, size_t blockBytes = 1u << 20) {
+    result.clear();
+    if (k == 0) return true;
+    bool ok = streamServices(filename, blockBytes, [&](const ServiceView& view) {
+        if (result.size() < k) {
+            result.emplace_back(std::string(view.name), view.cost, view.duration, view.prepayment);
+            std::push_heap(result.begin(), result.end());
+        } else if (serviceViewLess(view, result.front())) {
+            std::pop_heap(result.begin(), result.end());
+            Service& slot = result.back();
+            slot.name.assign(view.name.data(), view.name.size());
+            slot.cost = view.cost;
+            slot.duration = view.duration;
+            slot.prepayment = view.prepayment;
+            std::push_heap(result.begin(), result.end());
+        }
+    });
+    std::sort_heap(result.begin(), result.end());
+    return ok;
+}
+
+
+/**
+ * @brief Отсортированный индекс услуг с пакетными вставками и удалениями (отсортированные серии в стиле LSM).
+ *
+ * Записи хранятся в нескольких отсортированных по Service::operator< сериях, от старых и крупных к
+ * новым и мелким. Пакет вставок сортируется отдельно и добавляется новой серией; пока предыдущая
+ * серия не больше последней, они сливаются (как разряды двоичного счетчика), поэтому серий
+ * остается O(log n), а каждая запись перемещается O(log n) раз. Чтение - слияние серий на лету.
+ */
+class SortedServiceIndex {
+public:
+    SortedServiceIndex() = default;
+
+    /**
+     * @brief Строит индекс из набора записей (одна серия).
+     * @param services Записи в произвольном порядке.
+     */
+    explicit SortedServiceIndex(std::vector<Service> services) {
+        insertBatch(std::move(services));
+    }
+
+    /**
+     * @brief Загружает индекс из CSV-файла формата saveServices.
+     * Если файл уже отсортирован (например, записан save()), повторная сортировка не выполняется.
+     * @param filename Путь к CSV-файлу.
+     * @return True, если загрузка прошла успешно, иначе false.
+     * @throws std::runtime_error Если файл не удается открыть.
+     */
+    bool load(const std::string& filename) {
+        std::vector<Service> services;
+        bool ok = loadServices(filename, services);
+        runs.clear();
+        recordCount = services.size();
+        if (services.empty()) return ok;
+        if (!std::is_sorted(services.begin(), services.end())) {
+            std::sort(services.begin(), services.end());
+        }
+        runs.push_back(std::move(services));
+        return ok;
+    }
+
+    /**
+     * @brief Вставляет пакет записей.
+     * @param batch Новые записи в произвольном порядке.
+     */
+    void insertBatch(std::vector<Service> batch) {
+        if (batch.empty()) return;
+        std::sort(batch.begin(), batch.end());
+        recordCount += batch.size();
+        runs.push_back(std::move(batch));
+        while (runs.size() > 1 && runs[runs.size() - 2].size() <= runs.back().size()) {
+            mergeLastRuns();
+        }
+    }
+
+    /**
+     * @brief Удаляет пакет записей: по одному вхождению на каждую запись пакета (равенство по Service::operator==).
+     * В каждой серии записи ищутся бинарным поиском, затем серия уплотняется, начиная с первого удаления.
+     * @param batch Удаляемые записи в произвольном порядке.
+     * @return Количество удаленных записей (записи, которых нет в индексе, пропускаются).
+     */
+    size_t eraseBatch(std::vector<Service> batch) {
+        std::sort(batch.begin(), batch.end());
+        std::vector<char> matched(batch.size(), 0);
+        size_t removed = 0;
+        std::vector<size_t> positions;
+        for (size_t r = runs.size(); r-- > 0;) {
+            std::vector<Service>& run = runs[r];
+            positions.clear();
+            auto from = run.begin();
+            for (size_t i = 0; i < batch.size() && from != run.end(); ++i) {
+                if (matched[i]) continue;
+                auto it = std::lower_bound(from, run.end(), batch[i]);
+                if (it != run.end() && *it == batch[i]) {
+                    positions.push_back(static_cast<size_t>(it - run.begin()));
+                    matched[i] = 1;
+                    ++it;
+                }
+                from = it;
+            }
+            if (positions.empty()) continue;
+
+            size_t write = positions[0];
+            for (size_t p = 0; p < positions.size(); ++p) {
+                size_t next = p + 1 < positions.size() ? positions[p + 1] : run.size();
+                for (size_t read = positions[p] + 1; read < next; ++read) {
+                    run[write++] = std::move(run[read]);
+                }
+            }
+            run.resize(write);
+            removed += positions.size();
+        }
+        runs.erase(std::remove_if(runs.begin(), runs.end(), [](const std::vector<Service>& run) { return run.empty(); }), runs.end());
+        recordCount -= removed;
+        return removed;
+    }
+
+    /**
+     * @brief Обходит записи со стоимостью в [minCost, maxCost] в порядке Service::operator<.
+     * @tparam Visit Тип обработчика, вызываемого как visit(const Service&).
+     */
+    template<typename Visit>
+    void scanCost(double minCost, double maxCost, Visit visit) const {
+        std::vector<std::pair<const Service*, const Service*>> ranges;
+        for (const auto& run : runs) {
+            auto first = std::lower_bound(run.begin(), run.end(), minCost,
+                                          [](const Service& s, double cost) { return s.cost < cost; });
+            auto last = std::upper_bound(first, run.end(), maxCost,
+                                         [](double cost, const Service& s) { return cost < s.cost; });
+            if (first != last) ranges.emplace_back(&*first, &*first + (last - first));
+        }
+        mergeRanges(ranges, visit);
+    }
+
+    /**
+     * @brief Обходит все записи в порядке Service::operator<.
+     * @tparam Visit Тип обработчика, вызываемого как visit(const Service&).
+     */
+    template<typename Visit>
+    void forEach(Visit visit) const {
+        std::vector<std::pair<const Service*, const Service*>> ranges;
+        for (const auto& run : runs) {
+            if (!run.empty()) ranges.emplace_back(run.data(), run.data() + run.size());
+        }
+        mergeRanges(ranges, visit);
+    }
+
+    /**
+     * @brief Записывает индекс в CSV в формате saveServices, сливая серии на лету без промежуточного вектора.
+     * @param filename Путь к выходному файлу.
+     * @param backgroundWrite Выполнять запись на диск в фоновом потоке.
+     * @return True, если запись прошла успешно, иначе false.
+     * @throws std::runtime_error Если файл не удается открыть.
+     */
+    bool save(const std::string& filename, bool backgroundWrite = false) const {
+        CsvBlockWriter writer(filename, backgroundWrite);
+        writer.write("Название услуги,Ориентировочная стоимость,Срок исполнения (дни),Размер предоплаты\n");
+        forEach([&writer](const Service& service) {
+            writer.writeService(service.name, service.cost, service.duration, service.prepayment);
+        });
+        if (!writer.close()) {
+            std::cerr << "Ошибка записи в файл: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Сливает все серии в одну.
+     */
+    void compact() {
+        while (runs.size() > 1) mergeLastRuns();
+    }
+
+    /**
+     * @brief Возвращает все записи одним отсортированным вектором.
+     */
+    std::vector<Service> toVector() const {
+        std::vector<Service> result;
+        result.reserve(recordCount);
+        forEach([&result](const Service& service) { result.push_back(service); });
+        return result;
+    }
+
+    /**
+     * @brief Возвращает количество записей.
+     */
+    size_t size() const { return recordCount; }
+
+    /**
+     * @brief Возвращает количество отсортированных серий.
+     */
+    size_t runCount() const { return runs.size(); }
+
+private:
+    void mergeLastRuns() {
+        std::vector<Service> newer = std::move(runs.back());
+        runs.pop_back();
+        std::vector<Service>& older = runs.back();
+        std::vector<Service> merged;
+        merged.reserve(older.size() + newer.size());
+        std::merge(std::make_move_iterator(older.begin()), std::make_move_iterator(older.end()),
+                   std::make_move_iterator(newer.begin()), std::make_move_iterator(newer.end()),
+                   std::back_inserter(merged));
+        older.swap(merged);
+    }
+
+    // Серий O(log n), поэтому наименьшая текущая запись выбирается линейным просмотром;
+    // последний оставшийся диапазон выводится без сравнений.
+    template<typename Visit>
+    static void mergeRanges(std::vector<std::pair<const Service*, const Service*>>& ranges, Visit& visit) {
+        while (ranges.size() > 1) {
+            size_t best = 0;
+            for (size_t i = 1; i < ranges.size(); ++i) {
+                if (*ranges[i].first < *ranges[best].first) best = i;
+            }
+            visit(*ranges[best].first);
+            if (++ranges[best].first == ranges[best].second) {
+                ranges.erase(ranges.begin() + best);
+            }
+        }
+        if (!ranges.empty()) {
+            for (const Service* p = ranges[0].first; p != ranges[0].second; ++p) visit(*p);
+        }
+    }
+
+    std::vector<std::vector<Service>> runs;
+    size_t recordCount = 0;
+};
+
+
+/**
+ * @brief Распределение входных данных для замеров адаптивных сортировок.
+ */
+enum class DatasetDistribution {
+    Random,         ///< Исходный порядок файла (случайный)
+    NearlySorted,   ///< Отсортированные данные, в конец которых дописаны новые записи в случайном порядке
+    Reversed,       ///< Отсортированные по убыванию
+    FewUnique       ///< Небольшое число различных записей, повторяющихся в случайном порядке
+};
+
+
+/**
+ * @brief Возвращает имя распределения для столбца Distribution в CSV.
+ */
+const char* distributionName(DatasetDistribution distribution) {
+    switch (distribution) {
+        case DatasetDistribution::NearlySorted: return "nearly_sorted";
+        case DatasetDistribution::Reversed: return "reversed";
+        case DatasetDistribution::FewUnique: return "few_unique";
+        default: return "random";
+    }
+}
+
+
+/**
+ * @brief Доля записей, дописанных в конец почти отсортированного набора в случайном порядке.
+ */
+const double NEARLY_SORTED_APPENDED_FRACTION = 0.05;
+
+/**
+ * @brief Количество различных записей в наборе с малым числом уникальных значений.
+ */
+const size_t FEW_UNIQUE_DISTINCT_VALUES = 16;
+
+
+/**
+ * @brief Строит вариант набора данных с заданным распределением из исходных (случайно упорядоченных) записей.
+ * Генератор инициализируется фиксированным значением, поэтому варианты воспроизводимы между запусками.
+ * @param data Исходные записи.
+ * @param distribution Требуемое распределение.
+ * @return Новый набор того же размера.
+ */
+std::vector<Service> makeDatasetVariant(const std::vector<Service>& data, DatasetDistribution distribution) {
+    std::vector<Service> result = data;
+    std::mt19937 random(12345);
+    switch (distribution) {
+        case DatasetDistribution::NearlySorted: {
+            size_t sortedPart = result.size() - static_cast<size_t>(result.size() * NEARLY_SORTED_APPENDED_FRACTION);
+            std::sort(result.begin(), result.begin() + sortedPart);
+            break;
+        }
+        case DatasetDistribution::Reversed:
+            std::sort(result.begin(), result.end(), std::greater<Service>());
+            break;
+        case DatasetDistribution::FewUnique: {
+            size_t distinct = std::min(FEW_UNIQUE_DISTINCT_VALUES, data.size());
+            if (distinct == 0) break;
+            std::uniform_int_distribution<size_t> pick(0, distinct - 1);
+            for (auto& service : result) {
+                service = data[pick(random)];
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    return result;
+}
+
+
+/**
+ * @brief Генерирует набор записей произвольного размера по образцу существующего набора (C++-аналог gen.ipynb).
+ * Название и срок берутся у случайной записи-образца, стоимость отклоняется от образца на ±20%,
+ * предоплата составляет 10-60% стоимости, как в gen.ipynb; значения округляются до копеек.
+ * Генератор инициализируется seed, поэтому результат воспроизводим.
+ * @param templates Записи-образцы (например, самый большой набор из datasets/).
+ * @param count Количество записей.
+ * @param seed Начальное значение генератора.
+ * @return Сгенерированные записи (пусто, если образцов нет).
+ */
+std::vector<Service> generateServices(const std::vector<Service>& templates, size_t count, uint64_t seed = 2024) {
+    std::vector<Service> result;
+    if (templates.empty()) return result;
+    result.reserve(count);
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<size_t> pickTemplate(0, templates.size() - 1);
+    std::uniform_real_distribution<double> costFactor(0.8, 1.2);
+    std::uniform_real_distribution<double> prepaymentShare(0.1, 0.6);
+    auto roundToCents = [](double value) { return std::round(value * 100.0) / 100.0; };
+    for (size_t i = 0; i < count; ++i) {
+        const Service& base = templates[pickTemplate(random)];
+        double cost = roundToCents(base.cost * costFactor(random));
+        result.emplace_back(base.name, cost, base.duration, roundToCents(cost * prepaymentShare(random)));
+    }
+    return result;
+}
+
+
+/**
+ * @brief Пул потоков с захватом работы (work stealing).
+ *
+ * У каждого рабочего потока своя очередь задач: поток берет задачи с конца своей очереди,
+ * а при ее опустошении забирает задачи с начала чужих очередей. Поток, ожидающий
+ * завершения подзадачи, может выполнять чужие задачи через waitFor(), поэтому
+ * рекурсивные алгоритмы вида fork-join не блокируют пул.
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @brief Создает пул и запускает рабочие потоки.
+     * @param workerCount Количество рабочих потоков (может быть 0 - тогда задачи выполняет только вызывающий поток).
+     */
+    explicit WorkStealingPool(unsigned workerCount) {
+        unsigned queueCount = std::max(1u, workerCount);
+        for (unsigned i = 0; i < queueCount; ++i) {
+            queues.push_back(std::make_unique<TaskQueue>());
+        }
+        for (unsigned i = 0; i < workerCount; ++i) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    /**
+     * @brief Дожидается выполнения оставшихся задач и останавливает рабочие потоки.
+     */
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Ставит задачу в очередь. Из рабочего потока - в его собственную очередь, иначе - по кругу.
+     * @param task Задача.
+     */
+    void submit(std::function<void()> task) {
+        size_t target = (currentPool == this) ? currentIndex : nextQueue++ % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        ++pending;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeUp.notify_one();
+    }
+
+    /**
+     * @brief Выполняет одну задачу из своей очереди или захватывает ее у другого потока.
+     * @return True, если задача была выполнена, false - если очереди пусты.
+     */
+    bool runPendingTask() {
+        bool isWorker = (currentPool == this);
+        size_t own = isWorker ? currentIndex : 0;
+        std::function<void()> task;
+        for (size_t attempt = 0; attempt < queues.size() && !task; ++attempt) {
+            TaskQueue& queue = *queues[(own + attempt) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (attempt == 0 && isWorker) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+        if (!task) return false;
+        --pending;
+        task();
+        return true;
+    }
+
+    /**
+     * @brief Ожидает установки флага, помогая пулу выполнять задачи.
+     * @param done Флаг завершения ожидаемой задачи.
+     */
+    void waitFor(const std::atomic<bool>& done) {
+        while (!done.load(std::memory_order_acquire)) {
+            if (!runPendingTask()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * @brief Возвращает количество рабочих потоков пула.
+     */
+    unsigned workerCount() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index) {
+        currentPool = this;
+        currentIndex = index;
+        while (true) {
+            if (runPendingTask()) continue;
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait(lock, [this]() { return stopping || pending.load() > 0; });
+            if (stopping && pending.load() == 0) break;
+        }
+        currentPool = nullptr;
+    }
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> nextQueue{0};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+
+    static thread_local WorkStealingPool* currentPool;
+    static thread_local size_t currentIndex;
+};
+
+thread_local WorkStealingPool* WorkStealingPool::currentPool = nullptr;
+thread_local size_t WorkStealingPool::currentIndex = 0;
+
+
+/**
+ * @brief Размер диапазона, начиная с которого параллельная сортировка слиянием делит задачу.
+ */
+const size_t PARALLEL_SORT_CUTOFF = 4096;
+
+
+/**
+ * @brief Параллельно сливает два отсортированных диапазона в буфер.
+ * Больший диапазон делится пополам, граница в меньшем находится бинарным поиском,
+ * и две половины сливаются независимо.
+ */
+void parallelMerge(WorkStealingPool& pool,
+                   std::vector<Service>::iterator first1, std::vector<Service>::iterator last1,
+                   std::vector<Service>::iterator first2, std::vector<Service>::iterator last2,
+                   std::vector<Service>::iterator out) {
+    size_t size1 = last1 - first1;
+    size_t size2 = last2 - first2;
+    if (size1 + size2 <= PARALLEL_SORT_CUTOFF) {
+        std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+                   std::make_move_iterator(first2), std::make_move_iterator(last2), out);
+        return;
+    }
+    if (size1 < size2) {
+        std::swap(first1, first2);
+        std::swap(last1, last2);
+        std::swap(size1, size2);
+    }
+    auto mid1 = first1 + size1 / 2;
+    auto mid2 = std::lower_bound(first2, last2, *mid1);
+    auto outMid = out + (mid1 - first1) + (mid2 - first2);
+
+    std::atomic<bool> leftDone{false};
+    pool.submit([&]() {
+        parallelMerge(pool, first1, mid1, first2, mid2, out);
+        leftDone.store(true, std::memory_order_release);
+    });
+    parallelMerge(pool, mid1, last1, mid2, last2, outMid);
+    pool.waitFor(leftDone);
+}
+
+
+/**
+ * @brief Рекурсивная часть параллельной сортировки слиянием.
+ * Сортирует [first, last); результат остается в исходном диапазоне, buffer используется как временная память.
+ */
+void parallelMergeSortRange(WorkStealingPool& pool,
+                            std::vector<Service>::iterator first, std::vector<Service>::iterator last,
+                            std::vector<Service>::iterator buffer) {
+    size_t n = last - first;
+    if (n <= PARALLEL_SORT_CUTOFF) {
+        std::sort(first, last);
+        return;
+    }
+    auto mid = first + n / 2;
+
+    std::atomic<bool> leftDone{false};
+    pool.submit([&]() {
+        parallelMergeSortRange(pool, first, mid, buffer);
+        leftDone.store(true, std::memory_order_release);
+    });
+    parallelMergeSortRange(pool, mid, last, buffer + n / 2);
+    pool.waitFor(leftDone);
+
+    parallelMerge(pool, first, mid, mid, last, buffer);
+    std::move(buffer, buffer + n, first);
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service параллельной сортировкой слиянием на пуле с захватом работы.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param pool Пул потоков; вызывающий поток также участвует в работе.
+ */
+void parallelMergeSort(std::vector<Service>& arr, WorkStealingPool& pool) {
+    std::vector<Service> buffer(arr.size());
+    parallelMergeSortRange(pool, arr.begin(), arr.end(), buffer.begin());
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service параллельной сортировкой слиянием.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param threadCount Общее количество потоков, включая вызывающий (0 - по числу аппаратных потоков).
+ */
+void parallelMergeSort(std::vector<Service>& arr, unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    WorkStealingPool pool(threadCount - 1);
+    parallelMergeSort(arr, pool);
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service с помощью std::sort(std::execution::par_unseq, ...).
+ * Количество потоков ограничивается через tbb::global_control, если стандартная библиотека
+ * использует TBB (libstdc++); в остальных реализациях оно определяется самой библиотекой.
+ * Без поддержки параллельных алгоритмов выполняется обычный std::sort.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param threadCount Желаемое количество потоков (0 - по умолчанию библиотеки).
+ */
+void parallelStdSort(std::vector<Service>& arr, unsigned threadCount) {
+#if defined(__cpp_lib_parallel_algorithm) || defined(__cpp_lib_execution)
+#ifdef SORT_BENCH_HAVE_TBB_CONTROL
+    std::unique_ptr<tbb::global_control> limit;
+    if (threadCount != 0) {
+        limit = std::make_unique<tbb::global_control>(tbb::global_control::max_allowed_parallelism, threadCount);
+    }
+#else
+    (void)threadCount;
+#endif
+    std::sort(std::execution::par_unseq, arr.begin(), arr.end());
+#else
+    (void)threadCount;
+    std::sort(arr.begin(), arr.end());
+#endif
+}
+
+
+/**
+ * @brief Выполняет задачи task(0) ... task(taskCount - 1) на пуле и дожидается их завершения.
+ * Вызывающий поток выполняет задачу 0 и помогает пулу, пока остальные не завершатся.
+ */
+void runParallelTasks(WorkStealingPool& pool, size_t taskCount, const std::function<void(size_t)>& task) {
+    if (taskCount == 0) return;
+    std::atomic<size_t> remaining{taskCount - 1};
+    std::atomic<bool> done{taskCount == 1};
+    for (size_t i = 1; i < taskCount; ++i) {
+        pool.submit([&, i]() {
+            task(i);
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                done.store(true, std::memory_order_release);
+            }
+        });
+    }
+    task(0);
+    pool.waitFor(done);
+}
+
+
+/**
+ * @brief Во сколько раз число корзин выборочной сортировки превышает число потоков (для балансировки нагрузки).
+ */
+const size_t SAMPLE_SORT_BUCKETS_PER_THREAD = 4;
+
+/**
+ * @brief Количество элементов выборки на одну корзину при выборе разделителей.
+ */
+const size_t SAMPLE_SORT_OVERSAMPLING = 32;
+
+
+/**
+ * @brief Параллельная выборочная сортировка (sample sort, неустойчивая).
+ * 1. Из случайной выборки выбираются разделители корзин (по SAMPLE_SORT_OVERSAMPLING элементов на корзину).
+ * 2. Вход делится на блоки по числу потоков; каждый блок определяет корзины своих элементов и строит свою гистограмму.
+ * 3. По префиксным суммам гистограмм каждый блок независимо переносит свои элементы в буфер.
+ * 4. Корзины сортируются std::sort параллельно, буфер становится результатом.
+ * В отличие от слияния, каждый элемент перемещается между массивами только один раз.
+ * @param arr Вектор для сортировки (изменяется на месте).
+ * @param comp Предикат "меньше".
+ * @param pool Пул потоков; вызывающий поток также участвует в работе.
+ */
+template<typename T, typename Compare>
+void parallelSampleSort(std::vector<T>& arr, Compare comp, WorkStealingPool& pool) {
+    size_t n = arr.size();
+    size_t threads = pool.workerCount() + 1;
+    if (n <= PARALLEL_SORT_CUTOFF || threads == 1) {
+        std::sort(arr.begin(), arr.end(), comp);
+        return;
+    }
+
+    size_t bucketCount = std::min(threads * SAMPLE_SORT_BUCKETS_PER_THREAD, n / PARALLEL_SORT_CUTOFF + 1);
+    std::vector<T> splitters;
+    if (bucketCount > 1) {
+        std::mt19937_64 random(n);
+        std::uniform_int_distribution<size_t> pick(0, n - 1);
+        std::vector<T> sample;
+        sample.reserve(bucketCount * SAMPLE_SORT_OVERSAMPLING);
+        for (size_t i = 0; i < bucketCount * SAMPLE_SORT_OVERSAMPLING; ++i) {
+            sample.push_back(arr[pick(random)]);
+        }
+        std::sort(sample.begin(), sample.end(), comp);
+        for (size_t b = 1; b < bucketCount; ++b) {
+            splitters.push_back(sample[b * SAMPLE_SORT_OVERSAMPLING]);
+        }
+    }
+    bucketCount = splitters.size() + 1;
+
+    size_t blockCount = threads;
+    size_t blockSize = (n + blockCount - 1) / blockCount;
+    std::vector<uint32_t> bucketOf(n);
+    std::vector<std::vector<size_t>> histograms(blockCount, std::vector<size_t>(bucketCount, 0));
+    runParallelTasks(pool, blockCount, [&](size_t block) {
+        size_t begin = std::min(n, block * blockSize);
+        size_t end = std::min(n, begin + blockSize);
+        auto& histogram = histograms[block];
+        for (size_t i = begin; i < end; ++i) {
+            size_t bucket = std::upper_bound(splitters.begin(), splitters.end(), arr[i], comp) - splitters.begin();
+            bucketOf[i] = static_cast<uint32_t>(bucket);
+            ++histogram[bucket];
+        }
+    });
+
+    // Префиксные суммы: корзины по порядку, внутри корзины - блоки по порядку.
+    std::vector<size_t> bucketStart(bucketCount + 1, 0);
+    size_t offset = 0;
+    for (size_t b = 0; b < bucketCount; ++b) {
+        bucketStart[b] = offset;
+        for (size_t block = 0; block < blockCount; ++block) {
+            size_t count = histograms[block][b];
+            histograms[block][b] = offset;
+            offset += count;
+        }
+    }
+    bucketStart[bucketCount] = n;
+
+    std::vector<T> buffer(n);
+    runParallelTasks(pool, blockCount, [&](size_t block) {
+        size_t begin = std::min(n, block * blockSize);
+        size_t end = std::min(n, begin + blockSize);
+        auto& position = histograms[block];
+        for (size_t i = begin; i < end; ++i) {
+            buffer[position[bucketOf[i]]++] = std::move(arr[i]);
+        }
+    });
+
+    runParallelTasks(pool, bucketCount, [&](size_t b) {
+        std::sort(buffer.begin() + bucketStart[b], buffer.begin() + bucketStart[b + 1], comp);
+    });
+    arr.swap(buffer);
+}
+
+
+/**
+ * @brief Сортирует вектор объектов Service параллельной выборочной сортировкой.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param threadCount Общее количество потоков, включая вызывающий (0 - по числу аппаратных потоков).
+ */
+void parallelSampleSort(std::vector<Service>& arr, unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    WorkStealingPool pool(threadCount - 1);
+    parallelSampleSort(arr, std::less<Service>(), pool);
+}
+
+
+/**
+ * @brief Параллельная сортировка с точками отмены: куски сортируются независимыми задачами пула,
+ * затем попарно сливаются по раундам. Условие остановки проверяется только перед каждым куском и слиянием
+ * (после последнего слияния - нет, поэтому успевшая завершиться сортировка не считается прерванной);
+ * если оно выполнилось, работа прекращается, а порядок в arr не определен.
+ * @param arr Вектор для сортировки (изменяется на месте).
+ * @param comp Предикат сравнения.
+ * @param pool Пул потоков; вызывающий поток участвует в работе.
+ * @param chunkCount Количество кусков (не меньше 1).
+ * @param shouldStop Возвращает true, если работу нужно прекратить.
+ * @return True, если сортировка завершена, false - если она прервана.
+ */
+template<typename Compare, typename ShouldStop>
+bool cancellableParallelSort(std::vector<Service>& arr, Compare comp, WorkStealingPool& pool, size_t chunkCount,
+                             ShouldStop shouldStop) {
+    size_t n = arr.size();
+    chunkCount = std::max<size_t>(1, std::min(chunkCount, n / PARALLEL_SORT_CUTOFF + 1));
+    std::vector<size_t> bounds(chunkCount + 1);
+    for (size_t c = 0; c <= chunkCount; ++c) bounds[c] = n * c / chunkCount;
+
+    std::atomic<bool> stopped{false};
+    auto stop = [&]() {
+        if (!stopped.load(std::memory_order_relaxed) && shouldStop()) stopped.store(true, std::memory_order_relaxed);
+        return stopped.load(std::memory_order_relaxed);
+    };
+    runParallelTasks(pool, chunkCount, [&](size_t c) {
+        if (!stop()) std::sort(arr.begin() + bounds[c], arr.begin() + bounds[c + 1], comp);
+    });
+
+    std::vector<Service> buffer(chunkCount > 1 ? n : 0);
+    while (bounds.size() > 2 && !stop()) {
+        size_t pairs = (bounds.size() - 1) / 2;
+        runParallelTasks(pool, pairs, [&](size_t p) {
+            if (stop()) return;
+            auto first = arr.begin() + bounds[2 * p];
+            auto middle = arr.begin() + bounds[2 * p + 1];
+            auto last = arr.begin() + bounds[2 * p + 2];
+            std::merge(std::make_move_iterator(first), std::make_move_iterator(middle),
+                       std::make_move_iterator(middle), std::make_move_iterator(last),
+                       buffer.begin() + bounds[2 * p], comp);
+            std::move(buffer.begin() + bounds[2 * p], buffer.begin() + bounds[2 * p + 2], first);
+        });
+        std::vector<size_t> merged;
+        for (size_t b = 0; b < bounds.size(); b += 2) merged.push_back(bounds[b]);
+        if (merged.back() != n) merged.push_back(n);
+        bounds.swap(merged);
+    }
+    return !stopped.load(std::memory_order_relaxed);
+}
+
+
+/**
+ * @brief Размер задания, до которого SortService сортирует его сразу в вызывающем потоке.
+ */
+const size_t SORT_SERVICE_INLINE_THRESHOLD = 1024;
+
+/**
+ * @brief Размер задания, начиная с которого SortService делит его между рабочими потоками.
+ */
+const size_t SORT_SERVICE_SPLIT_THRESHOLD = 32768;
+
+
+/**
+ * @brief Итог задания сортировки.
+ */
+enum class SortJobStatus {
+    Completed,          ///< Данные отсортированы
+    Cancelled,          ///< Задание отменено через SortJob::cancel()
+    DeadlineExceeded    ///< Срок истек до завершения сортировки
+};
+
+
+/**
+ * @brief Возвращает имя итога задания (completed, cancelled, deadline_exceeded).
+ */
+const char* sortJobStatusName(SortJobStatus status) {
+    switch (status) {
+        case SortJobStatus::Completed: return "completed";
+        case SortJobStatus::Cancelled: return "cancelled";
+        case SortJobStatus::DeadlineExceeded: return "deadline_exceeded";
+    }
+    return "unknown";
+}
+
+
+/**
+ * @brief Результат задания сортировки.
+ */
+struct SortJobResult {
+    SortJobStatus status = SortJobStatus::Completed;
+    std::vector<Service> data;   ///< Отсортированные данные (при отмене - в неопределенном порядке)
+    double queueMs = 0.0;        ///< Ожидание в очереди пула
+    double runMs = 0.0;          ///< Выполнение
+};
+
+
+/**
+ * @brief Отправленное задание: будущий результат и возможность отменить задание.
+ */
+struct SortJob {
+    std::future<SortJobResult> result;
+    std::shared_ptr<std::atomic<bool>> cancelFlag;
+
+    /**
+     * @brief Запрашивает отмену. Задание останавливается в ближайшей точке отмены
+     * (перед началом, между кусками и слияниями); уже начатая сортировка куска доводится до конца.
+     */
+    void cancel() { cancelFlag->store(true, std::memory_order_relaxed); }
+};
+
+
+/**
+ * @brief Асинхронный сервис сортировки на общем пуле с захватом работы (WorkStealingPool).
+ *
+ * submit() принимает набор и спецификацию сортировки (parseSortSpec; пустая строка - Service::operator<)
+ * и возвращает SortJob с std::future. Спецификации из KnownSortSpecs сортируются компаратором SortSpec,
+ * остальные - универсальным компаратором makeRuntimeComparator. Маленькие задания (до inlineThreshold записей) сортируются сразу
+ * в вызывающем потоке, средние - одной задачей пула, большие (от splitThreshold) делятся на куски
+ * между рабочими потоками (cancellableParallelSort). Задания поддерживают отмену и срок выполнения.
+ */
+class SortService {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Создает сервис и запускает рабочие потоки.
+     * @param workerCount Рабочих потоков (0 - по числу аппаратных потоков; не меньше 1).
+     * @param inlineThreshold Размер, до которого задание выполняется в вызывающем потоке (0 - никогда).
+     * @param splitThreshold Размер, начиная с которого задание делится между потоками.
+     */
+    explicit SortService(unsigned workerCount = 0, size_t inlineThreshold = SORT_SERVICE_INLINE_THRESHOLD,
+                         size_t splitThreshold = SORT_SERVICE_SPLIT_THRESHOLD)
+        : pool(std::max(1u, workerCount ? workerCount : std::thread::hardware_concurrency())),
+          inlineThreshold(inlineThreshold), splitThreshold(splitThreshold) {}
+
+    /**
+     * @brief Отправляет задание сортировки.
+     * @param data Набор данных (перемещается в задание).
+     * @param spec Спецификация вида "duration,-cost" (пустая строка - порядок Service::operator<).
+     * @param deadline Срок, после которого незавершенное задание прекращается (по умолчанию - без срока).
+     * @return Задание с будущим результатом.
+     * @throws std::runtime_error Если спецификация некорректна.
+     */
+    SortJob submit(std::vector<Service> data, const std::string& spec = "",
+                   Clock::time_point deadline = Clock::time_point::max()) {
+        auto job = std::make_shared<Job>();
+        job->data = std::move(data);
+        if (spec.empty()) {
+            job->sort = makeSorter(std::less<Service>());
+        } else {
+            std::vector<RuntimeSortKey> keys = parseSortSpec(spec);
+            if (!visitKnownSortSpec(keys, [&](auto known) { job->sort = makeSorter(known); })) {
+                job->sort = makeSorter(makeRuntimeComparator(std::move(keys)));
+            }
+        }
+        job->deadline = deadline;
+        job->submitted = Clock::now();
+        SortJob handle{job->promise.get_future(), job->cancelFlag};
+        if (job->data.size() <= inlineThreshold) {
+            run(*job);
+        } else {
+            pool.submit([this, job]() { run(*job); });
+        }
+        return handle;
+    }
+
+    /**
+     * @brief Возвращает количество рабочих потоков.
+     */
+    unsigned workerCount() const { return pool.workerCount(); }
+
+private:
+    // Сортирует данные задания; возвращает true, если сортировка завершена, а не прервана.
+    using Sorter = std::function<bool(std::vector<Service>&, const std::function<bool()>&)>;
+
+    struct Job {
+        std::vector<Service> data;
+        Sorter sort;   ///< Сортировка с компаратором задания, подставленным в sortData
+        Clock::time_point deadline;
+        Clock::time_point submitted;
+        std::shared_ptr<std::atomic<bool>> cancelFlag = std::make_shared<std::atomic<bool>>(false);
+        std::promise<SortJobResult> promise;
+    };
+
+    void run(Job& job) {
+        SortJobResult result;
+        auto started = Clock::now();
+        result.queueMs = std::chrono::duration<double, std::milli>(started - job.submitted).count();
+        std::optional<SortJobStatus> stopReason;
+        auto shouldStop = [&]() {
+            if (job.cancelFlag->load(std::memory_order_relaxed)) stopReason = SortJobStatus::Cancelled;
+            else if (Clock::now() >= job.deadline) stopReason = SortJobStatus::DeadlineExceeded;
+            return stopReason.has_value();
+        };
+        bool completed = false;
+        try {
+            if (!shouldStop()) {
+                completed = job.sort(job.data, shouldStop);
+            }
+        } catch (...) {
+            job.promise.set_exception(std::current_exception());
+            return;
+        }
+        result.status = completed ? SortJobStatus::Completed : stopReason.value_or(SortJobStatus::Cancelled);
+        result.data = std::move(job.data);
+        result.runMs = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+        job.promise.set_value(std::move(result));
+    }
+
+    // Тип компаратора сохраняется в sortData, поэтому сравнения SortSpec встраиваются.
+    template<typename Compare>
+    Sorter makeSorter(Compare comp) {
+        return [this, comp](std::vector<Service>& data, const std::function<bool()>& shouldStop) {
+            return sortData(data, comp, shouldStop);
+        };
+    }
+
+    // Возвращает true, если сортировка завершена, а не прервана.
+    template<typename Compare, typename ShouldStop>
+    bool sortData(std::vector<Service>& data, const Compare& comp, const ShouldStop& shouldStop) {
+        if (data.size() < splitThreshold) {
+            std::sort(data.begin(), data.end(), comp);
+            return true;
+        }
+        std::mutex stopMutex;   // Условие остановки проверяется из нескольких потоков
+        return cancellableParallelSort(data, comp, pool, 2 * (pool.workerCount() + 1), [&]() {
+            std::lock_guard<std::mutex> lock(stopMutex);
+            return shouldStop();
+        });
+    }
+
+    WorkStealingPool pool;
+    size_t inlineThreshold;
+    size_t splitThreshold;
+};
+
+
+/**
+ * @brief Алгоритм, выбранный autoSort.
+ */
+enum class AutoSortAlgorithm {
+    Insertion,   ///< Сортировка вставками (hybridInsertionSort)
+    Hybrid,      ///< Адаптивная гибридная сортировка (adaptiveSort)
+    Radix,       ///< Поразрядная сортировка (radixSort)
+    Parallel,    ///< Параллельная выборочная сортировка (parallelSampleSort)
+    External     ///< Внешняя сортировка файла (externalSort, только autoSortFile)
+};
+
+
+/**
+ * @brief Возвращает имя алгоритма autoSort (insertion, hybrid, radix, parallel, external).
+ */
+const char* autoSortAlgorithmName(AutoSortAlgorithm algorithm) {
+    switch (algorithm) {
+        case AutoSortAlgorithm::Insertion: return "insertion";
+        case AutoSortAlgorithm::Hybrid: return "hybrid";
+        case AutoSortAlgorithm::Radix: return "radix";
+        case AutoSortAlgorithm::Parallel: return "parallel";
+        case AutoSortAlgorithm::External: return "external";
+    }
+    return "unknown";
+}
+
+
+/**
+ * @brief Пороги выбора алгоритма autoSort. Значения по умолчанию заменяются файлом auto_sort.cfg,
+ * который пишет калибровочный прогон sort_bench --tune-auto-sort=on на целевой машине (см. loadAutoSortThresholds).
+ */
+struct AutoSortThresholds {
+    size_t insertionMaxSize = 24;             ///< До этого размера включительно - сортировка вставками
+    double presortedMaxDescentRatio = 0.05;   ///< Доля спусков в выборке (или подъемов для убывающих данных), ниже которой вход почти упорядочен
+    double duplicateMinRatio = 0.5;           ///< Доля повторяющихся стоимостей в выборке, начиная с которой - гибридная сортировка
+    size_t radixMinSize = 4096;               ///< От этого размера - поразрядная сортировка
+    size_t parallelMinSize = 262144;          ///< От этого размера при нескольких потоках - параллельная сортировка
+    uint64_t externalMinBytes = 1ull << 30;   ///< Файлы от этого размера autoSortFile сортирует внешней сортировкой
+};
+
+
+/**
+ * @brief Размер выборки, по которой autoSort оценивает входные данные.
+ */
+const size_t AUTO_SORT_SAMPLE_SIZE = 1024;
+
+
+/**
+ * @brief Характеристики входных данных, оцененные по равномерной выборке.
+ */
+struct DataProfile {
+    size_t size = 0;                 ///< Количество записей
+    size_t sampleSize = 0;           ///< Размер выборки
+    size_t sampleRuns = 0;           ///< Неубывающих серий в выборке (1 - выборка упорядочена)
+    double descentRatio = 0.0;       ///< Доля спусков между соседними элементами выборки (0 - по возрастанию, 1 - по убыванию)
+    double duplicateRatio = 0.0;     ///< Доля элементов выборки, стоимость которых повторяет уже встреченную
+    unsigned threads = 1;            ///< Доступных потоков
+};
+
+
+/**
+ * @brief Оценивает входные данные по выборке из sampleSize записей, взятых с равным шагом.
+ * Стоит O(sampleSize log sampleSize) и не зависит от размера набора.
+ * @param arr Записи.
+ * @param threads Доступных потоков (0 - по числу аппаратных потоков).
+ * @param sampleSize Размер выборки.
+ */
+DataProfile profileServices(const std::vector<Service>& arr, unsigned threads = 0, size_t sampleSize = AUTO_SORT_SAMPLE_SIZE) {
+    DataProfile profile;
+    profile.size = arr.size();
+    profile.threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    profile.sampleSize = std::min(sampleSize, arr.size());
+    if (profile.sampleSize == 0) return profile;
+
+    std::vector<uint64_t> keys(profile.sampleSize);
+    size_t descents = 0;
+    const Service* previous = nullptr;
+    for (size_t i = 0; i < profile.sampleSize; ++i) {
+        const Service& current = arr[i * arr.size() / profile.sampleSize];
+        if (previous && current < *previous) ++descents;
+        keys[i] = sortableDoubleBits(current.cost);
+        previous = &current;
+    }
+    profile.sampleRuns = descents + 1;
+    profile.descentRatio = profile.sampleSize > 1 ? static_cast<double>(descents) / (profile.sampleSize - 1) : 0.0;
+
+    std::sort(keys.begin(), keys.end());
+    size_t repeats = 0;
+    for (size_t i = 1; i < keys.size(); ++i) repeats += keys[i] == keys[i - 1];
+    profile.duplicateRatio = static_cast<double>(repeats) / keys.size();
+    return profile;
+}
+
+
+/**
+ * @brief Выбирает алгоритм для данных в памяти по характеристикам и порогам.
+ * @param profile Характеристики набора.
+ * @param thresholds Пороги.
+ * @param reason Краткое обоснование выбора (выходной параметр).
+ */
+AutoSortAlgorithm chooseAutoSortAlgorithm(const DataProfile& profile, const AutoSortThresholds& thresholds, std::string& reason) {
+    double presorted = thresholds.presortedMaxDescentRatio;
+    if (profile.size <= thresholds.insertionMaxSize) {
+        reason = "small";
+        return AutoSortAlgorithm::Insertion;
+    }
+    if (profile.descentRatio <= presorted || profile.descentRatio >= 1.0 - presorted) {
+        reason = "presorted";
+        return AutoSortAlgorithm::Hybrid;
+    }
+    if (profile.duplicateRatio >= thresholds.duplicateMinRatio) {
+        reason = "duplicates";
+        return AutoSortAlgorithm::Hybrid;
+    }
+    if (profile.threads > 1 && profile.size >= thresholds.parallelMinSize) {
+        reason = "large";
+        return AutoSortAlgorithm::Parallel;
+    }
+    if (profile.size >= thresholds.radixMinSize) {
+        reason = "random";
+        return AutoSortAlgorithm::Radix;
+    }
+    reason = "default";
+    return AutoSortAlgorithm::Hybrid;
+}
+
+
+/**
+ * @brief Решение autoSort: характеристики входа, выбранный алгоритм и время.
+ */
+struct AutoSortDecision {
+    DataProfile profile;
+    AutoSortAlgorithm algorithm = AutoSortAlgorithm::Hybrid;
+    std::string reason;         ///< Обоснование (small, presorted, duplicates, large, random, default, file_size)
+    double profileMs = 0.0;     ///< Оценка входа и выбор
+    double sortMs = 0.0;        ///< Сортировка выбранным алгоритмом
+};
+
+
+/**
+ * @brief Сортирует записи алгоритмом, выбранным по выборке из входа (см. profileServices, chooseAutoSortAlgorithm).
+ * Результат совпадает с Service::operator<.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param thresholds Пороги выбора.
+ * @param pool Пул для параллельной сортировки; число потоков - его рабочие потоки и вызывающий.
+ * @return Принятое решение и время этапов.
+ */
+AutoSortDecision autoSort(std::vector<Service>& arr, const AutoSortThresholds& thresholds, WorkStealingPool& pool) {
+    AutoSortDecision decision;
+    auto start = std::chrono::steady_clock::now();
+    decision.profile = profileServices(arr, pool.workerCount() + 1);
+    decision.algorithm = chooseAutoSortAlgorithm(decision.profile, thresholds, decision.reason);
+    auto sortStart = std::chrono::steady_clock::now();
+    switch (decision.algorithm) {
+        case AutoSortAlgorithm::Insertion:
+            hybridInsertionSort(arr.begin(), arr.end(), std::less<Service>());
+            break;
+        case AutoSortAlgorithm::Radix:
+            radixSort(arr);
+            break;
+        case AutoSortAlgorithm::Parallel:
+            parallelSampleSort(arr, std::less<Service>(), pool);
+            break;
+        default:
+            adaptiveSort(arr);
+            break;
+    }
+    auto end = std::chrono::steady_clock::now();
+    decision.profileMs = std::chrono::duration<double, std::milli>(sortStart - start).count();
+    decision.sortMs = std::chrono::duration<double, std::milli>(end - sortStart).count();
+    return decision;
+}
+
+
+/**
+ * @brief Сортирует записи autoSort на временном пуле из threads потоков.
+ * Для однократной сортировки; при повторных вызовах передавайте общий пул, чтобы не запускать потоки каждый раз.
+ * @param arr Вектор Service для сортировки (изменяется на месте).
+ * @param thresholds Пороги выбора.
+ * @param threads Потоков для параллельной сортировки (0 - по числу аппаратных потоков).
+ * @return Принятое решение и время этапов.
+ */
+AutoSortDecision autoSort(std::vector<Service>& arr, const AutoSortThresholds& thresholds = AutoSortThresholds(),
+                          unsigned threads = 0) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    WorkStealingPool pool(threads - 1);
+    return autoSort(arr, thresholds, pool);
+}
+
+
+/**
+ * @brief Сортирует CSV-файл: файлы от thresholds.externalMinBytes - внешней сортировкой,
+ * остальные загружаются, сортируются autoSort и сохраняются.
+ * @param inputFilename Путь к входному CSV-файлу.
+ * @param outputFilename Путь к выходному CSV-файлу.
+ * @param thresholds Пороги выбора.
+ * @param externalConfig Параметры внешней сортировки.
+ * @param pool Пул для параллельной сортировки в памяти.
+ * @param decision Принятое решение (выходной параметр; для внешней сортировки profile содержит только size).
+ * @return True, если сортировка и сохранение прошли успешно.
+ * @throws std::runtime_error Если файл не удается открыть.
+ */
+bool autoSortFile(const std::string& inputFilename, const std::string& outputFilename, const AutoSortThresholds& thresholds,
+                  const ExternalSortConfig& externalConfig, WorkStealingPool& pool, AutoSortDecision& decision) {
+    decision = AutoSortDecision();
+    if (std::filesystem::file_size(inputFilename) >= thresholds.externalMinBytes) {
+        decision.algorithm = AutoSortAlgorithm::External;
+        decision.reason = "file_size";
+        ExternalSortStats stats;
+        auto start = std::chrono::steady_clock::now();
+        bool ok = externalSort(inputFilename, outputFilename, externalConfig, stats);
+        decision.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        decision.profile.size = stats.records;
+        return ok;
+    }
+    std::vector<Service> services;
+    if (!loadServices(inputFilename, services)) return false;
+    decision = autoSort(services, thresholds, pool);
+    return saveServicesFast(outputFilename, services);
+}
+
+
+/**
+ * @brief Хранилище услуг в виде структуры массивов (SoA).
+ *
+ * Каждое поле хранится в отдельном массиве, названия - в общем пуле строк, а для каждой
+ * записи хранится смещение и длина названия в пуле. Сравнение по стоимости и предоплате
+ * затрагивает только соответствующие массивы и не тянет в кэш названия.
+ */
+struct ServiceTable {
+    std::vector<double> cost;           ///< Ориентировочная стоимость
+    std::vector<double> prepayment;     ///< Размер предоплаты
+    std::vector<int> duration;          ///< Срок исполнения (дни)
+    std::vector<uint32_t> nameOffset;   ///< Смещение названия в namePool
+    std::vector<uint32_t> nameLength;   ///< Длина названия в байтах
+    std::string namePool;               ///< Пул названий
+
+    /**
+     * @brief Возвращает количество записей.
+     */
+    size_t size() const { return cost.size(); }
+
+    /**
+     * @brief Удаляет все записи.
+     */
+    void clear() {
+        cost.clear();
+        prepayment.clear();
+        duration.clear();
+        nameOffset.clear();
+        nameLength.clear();
+        namePool.clear();
+    }
+
+    /**
+     * @brief Резервирует память под заданное количество записей и байт названий.
+     */
+    void reserve(size_t records, size_t poolBytes) {
+        cost.reserve(records);
+        prepayment.reserve(records);
+        duration.reserve(records);
+        nameOffset.reserve(records);
+        nameLength.reserve(records);
+        namePool.reserve(poolBytes);
+    }
+
+    /**
+     * @brief Добавляет запись в конец таблицы, копируя название в пул.
+     */
+    void push_back(std::string_view name, double c, int d, double p) {
+        cost.push_back(c);
+        prepayment.push_back(p);
+        duration.push_back(d);
+        nameOffset.push_back(static_cast<uint32_t>(namePool.size()));
+        nameLength.push_back(static_cast<uint32_t>(name.size()));
+        namePool.append(name.data(), name.size());
+    }
+
+    /**
+     * @brief Возвращает название записи i как ссылку на пул.
+     */
+    std::string_view name(size_t i) const {
+        return std::string_view(namePool.data() + nameOffset[i], nameLength[i]);
+    }
+
+    /**
+     * @brief Сравнивает записи i и j в том же порядке, что и Service::operator<.
+     */
+    bool less(size_t i, size_t j) const {
+        if (cost[i] != cost[j]) {
+            return cost[i] < cost[j];
+        }
+        if (prepayment[i] != prepayment[j]) {
+            return prepayment[i] < prepayment[j];
+        }
+        return name(i) < name(j);
+    }
+
+    /**
+     * @brief Переставляет записи по перестановке: новая запись k - это прежняя запись order[k].
+     * Каждый столбец переставляется отдельным проходом; пул названий не изменяется.
+     * @param order Перестановка индексов длины size().
+     */
+    template<typename Index>
+    void applyOrder(const std::vector<Index>& order) {
+        gatherColumn(cost, order);
+        gatherColumn(prepayment, order);
+        gatherColumn(duration, order);
+        gatherColumn(nameOffset, order);
+        gatherColumn(nameLength, order);
+    }
+
+    /**
+     * @brief Строит таблицу из вектора Service.
+     */
+    static ServiceTable fromServices(const std::vector<Service>& services) {
+        ServiceTable table;
+        size_t poolBytes = 0;
+        for (const auto& service : services) poolBytes += service.name.size();
+        table.reserve(services.size(), poolBytes);
+        for (const auto& service : services) {
+            table.push_back(service.name, service.cost, service.duration, service.prepayment);
+        }
+        return table;
+    }
+
+    /**
+     * @brief Преобразует таблицу обратно в вектор Service.
+     */
+    std::vector<Service> toServices() const {
+        std::vector<Service> services;
+        services.reserve(size());
+        for (size_t i = 0; i < size(); ++i) {
+            services.emplace_back(std::string(name(i)), cost[i], duration[i], prepayment[i]);
+        }
+        return services;
+    }
+
+private:
+    template<typename T, typename Index>
+    static void gatherColumn(std::vector<T>& column, const std::vector<Index>& order) {
+        std::vector<T> gathered(order.size());
+        for (size_t k = 0; k < order.size(); ++k) {
+            gathered[k] = column[order[k]];
+        }
+        column.swap(gathered);
+    }
+};
+
+
+/**
+ * @brief Загружает данные об услугах из CSV-файла сразу в таблицу SoA (через быстрый загрузчик).
+ * @param filename Путь к CSV-файлу.
+ * @param table Таблица для сохранения загруженных записей (будет очищена перед загрузкой).
+ * @return True, если прочитан заголовок и есть данные, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть.
+ */
+bool loadServiceTable(const std::string& filename, ServiceTable& table) {
+    table.clear();
+    MappedFile file(filename);
+    std::vector<ServiceView> views;
+    if (!loadServicesMapped(file, views)) {
+        std::cerr << "Предупреждение: Не удалось загрузить данные в таблицу из файла: " << filename << std::endl;
+        return false;
+    }
+    size_t poolBytes = 0;
+    for (const auto& view : views) poolBytes += view.name.size();
+    table.reserve(views.size(), poolBytes);
+    for (const auto& view : views) {
+        table.push_back(view.name, view.cost, view.duration, view.prepayment);
+    }
+    return true;
+}
+
+
+/**
+ * @brief Сохраняет таблицу SoA в CSV-файл в том же формате, что и saveServices.
+ * @param filename Путь к выходному CSV-файлу.
+ * @param table Таблица с записями.
+ * @return True, если сохранение прошло успешно, иначе false.
+ * @throws std::runtime_error Если файл не удается открыть для записи.
+ */
+bool saveServiceTable(const std::string& filename, const ServiceTable& table) {
+    std::ofstream outFile(filename);
+    if (!outFile.is_open()) {
+        throw std::runtime_error("Ошибка: Не удалось открыть выходной файл для записи: " + filename);
+    }
+
+    outFile << "Название услуги,Ориентировочная стоимость,Срок исполнения (дни),Размер предоплаты\n";
+
+    for (size_t i = 0; i < table.size(); ++i) {
+        outFile << table.name(i) << ","
+                << std::fixed << std::setprecision(2) << table.cost[i] << ","
+                << table.duration[i] << ","
+                << std::fixed << std::setprecision(2) << table.prepayment[i] << "\n";
+    }
+
+    if (outFile.bad()) {
+        std::cerr << "Ошибка записи в файл: " << filename << std::endl;
+        outFile.close();
+        return false;
+    }
+
+    outFile.close();
+    return true;
+}
+
+
+/**
+ * @brief Сортирует таблицу SoA с помощью std::sort по массиву индексов.
+ * Сравниваются столбцы cost и prepayment, названия - только при их совпадении;
+ * затем столбцы переставляются по полученному порядку.
+ * @param table Таблица для сортировки (изменяется на месте).
+ */
+void sortTable(ServiceTable& table) {
+    std::vector<uint32_t> order(table.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+    std::sort(order.begin(), order.end(), [&table](uint32_t a, uint32_t b) { return table.less(a, b); });
+    table.applyOrder(order);
+}
+
+
+/**
+ * @brief Сортирует таблицу SoA поразрядной сортировкой (ключи строятся прямо из столбцов).
+ * @param table Таблица для сортировки (изменяется на месте).
+ */
+void radixSortTable(ServiceTable& table) {
+    size_t n = table.size();
+    std::vector<RadixSortKey> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = {sortableDoubleBits(table.cost[i]), sortableDoubleBits(table.prepayment[i]), static_cast<uint32_t>(i)};
+    }
+    radixSortKeys(keys, [&table](uint32_t a, uint32_t b) { return table.name(a) < table.name(b); });
+
+    std::vector<uint32_t> order(n);
+    for (size_t k = 0; k < n; ++k) order[k] = keys[k].index;
+    table.applyOrder(order);
+}
+
+
+/**
+ * @brief Значения аппаратных счетчиков производительности за один или несколько запусков.
+ * Счетчик, который не удалось открыть на данной платформе, помечается как недоступный.
+ */
+struct HardwareCounts {
+    enum Event { Cycles, Instructions, L1DMisses, LLCMisses, BranchMisses, EventCount };
+
+    std::array<bool, EventCount> available{};   ///< Доступен ли соответствующий счетчик
+    std::array<double, EventCount> values{};    ///< Значения счетчиков
+};
+
+
+/**
+ * @brief Аппаратные счетчики производительности текущего потока и порождаемых им потоков.
+ *
+ * На Linux используются perf_event_open (такты, инструкции, промахи L1D и LLC, ошибки
+ * предсказания переходов; только пользовательский режим). Счетчики открываются одной группой
+ * с тактами во главе, поэтому считаются за одни и те же интервалы; если PMU не может разместить
+ * группу целиком, они открываются по отдельности. При мультиплексировании каждое значение
+ * масштабируется на time_enabled / time_running. На Windows доступны только такты
+ * через QueryThreadCycleTime, остальные счетчики (ETW PMC требует сеанса трассировки с правами
+ * администратора) не собираются. На прочих платформах все счетчики недоступны.
+ */
+class HardwareCounters {
+public:
+    /**
+     * @brief Открывает доступные счетчики. Ошибки открытия не считаются фатальными.
+     */
+    HardwareCounters() {
+#ifdef __linux__
+        openEvents(true);
+        // Пробный замер: группа, не помещающаяся в PMU, никогда не запускается (time_running = 0).
+        start();
+        HardwareCounts probe = stop();
+        if (descriptors[HardwareCounts::Cycles] >= 0 && !probe.available[HardwareCounts::Cycles]) {
+            closeEvents();
+            openEvents(false);
+        }
+#endif
+    }
+
+    /**
+     * @brief Закрывает открытые счетчики.
+     */
+    ~HardwareCounters() {
+#ifdef __linux__
+        closeEvents();
+#endif
+    }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    /**
+     * @brief Проверяет, доступен ли хотя бы один счетчик.
+     */
+    bool anyAvailable() const {
+#ifdef __linux__
+        for (int fd : descriptors) {
+            if (fd >= 0) return true;
+        }
+        return false;
+#elif defined(_WIN32)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Обнуляет и запускает счетчики.
+     */
+    void start() {
+#ifdef __linux__
+        forEachControlled([](int fd, int flags) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, flags);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, flags);
+        });
+#elif defined(_WIN32)
+        QueryThreadCycleTime(GetCurrentThread(), &startCycles);
+#endif
+    }
+
+    /**
+     * @brief Останавливает счетчики и возвращает накопленные значения.
+     */
+    HardwareCounts stop() {
+        HardwareCounts counts;
+#ifdef __linux__
+        forEachControlled([](int fd, int flags) { ioctl(fd, PERF_EVENT_IOC_DISABLE, flags); });
+        for (size_t i = 0; i < descriptors.size(); ++i) {
+            if (descriptors[i] < 0) continue;
+            uint64_t sample[3] = {0, 0, 0};   // value, time_enabled, time_running
+            if (read(descriptors[i], sample, sizeof(sample)) == static_cast<ssize_t>(sizeof(sample)) && sample[2] > 0) {
+                counts.available[i] = true;
+                counts.values[i] = static_cast<double>(sample[0]);
+                if (sample[2] < sample[1]) counts.values[i] *= static_cast<double>(sample[1]) / sample[2];
+            }
+        }
+#elif defined(_WIN32)
+        ULONG64 endCycles = 0;
+        QueryThreadCycleTime(GetCurrentThread(), &endCycles);
+        counts.available[HardwareCounts::Cycles] = true;
+        counts.values[HardwareCounts::Cycles] = static_cast<double>(endCycles - startCycles);
+#endif
+        return counts;
+    }
+
+private:
+#ifdef __linux__
+    /**
+     * @brief Открывает счетчики; при grouped - одной группой под счетчиком тактов (если он доступен).
+     */
+    void openEvents(bool grouped) {
+        const std::array<std::pair<uint32_t, uint64_t>, HardwareCounts::EventCount> events = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        }};
+        groupLeader = -1;
+        for (size_t i = 0; i < events.size(); ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.disabled = groupLeader < 0 ? 1 : 0;   // Члены группы включаются вместе с ведущим
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            descriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupLeader, 0));
+            if (grouped && i == HardwareCounts::Cycles && descriptors[i] >= 0) groupLeader = descriptors[i];
+        }
+    }
+
+    /**
+     * @brief Закрывает открытые счетчики.
+     */
+    void closeEvents() {
+        for (int& fd : descriptors) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+        groupLeader = -1;
+    }
+
+    /**
+     * @brief Вызывает control(fd, flags) для ведущего группы (с PERF_IOC_FLAG_GROUP) или для каждого счетчика.
+     */
+    template<typename Control>
+    void forEachControlled(Control control) {
+        if (groupLeader >= 0) {
+            control(groupLeader, PERF_IOC_FLAG_GROUP);
+            return;
+        }
+        for (int fd : descriptors) {
+            if (fd >= 0) control(fd, 0);
+        }
+    }
+
+    std::array<int, HardwareCounts::EventCount> descriptors{{-1, -1, -1, -1, -1}};
+    int groupLeader = -1;   ///< Дескриптор счетчика тактов, если счетчики открыты группой
+#elif defined(_WIN32)
+    ULONG64 startCycles = 0;
+#endif
+};
+
+
+// Профиль сборки для столбца BuildProfile; задается CMake (параметр SORT_BENCH_PROFILE в CMakeLists.txt).
+#ifndef SORT_BENCH_BUILD_PROFILE
+#define SORT_BENCH_BUILD_PROFILE "unspecified"
+#endif
+
+
+/**
+ * @brief Возвращает название и версию компилятора, которым собрана программа.
+ */
+std::string compilerDescription() {
+#if defined(__clang__)
+    return std::string("Clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    return std::string("GCC ") + __VERSION__;
+#elif defined(_MSC_VER)
+    return "MSVC " + std::to_string(_MSC_FULL_VER);
+#else
+    return "unknown";
+#endif
+}
+
+
+/**
+ * @brief Возвращает поля BuildProfile и Compiler для строк CSV с результатами замеров (с ведущей запятой).
+ */
+const std::string& buildDescriptionCsvFields() {
+    static const std::string fields = std::string(",\"") + SORT_BENCH_BUILD_PROFILE + "\",\"" + compilerDescription() + "\"";
+    return fields;
+}
+
+
+/**
+ * @brief Возвращает заголовки столбцов AllocationStats для этапа: <phase>Allocations,<phase>Bytes,<phase>PeakBytes,<phase>PeakRssBytes.
+ * @param phase Название этапа (Load, Copy, Sort, Save).
+ */
+std::string allocationCsvHeader(const std::string& phase) {
+    return phase + "Allocations," + phase + "Bytes," + phase + "PeakBytes," + phase + "PeakRssBytes";
+}
+
+
+/**
+ * @brief Дописывает в строку CSV четыре поля AllocationStats, каждое с предшествующей запятой.
+ * Поля учета operator new пусты, если учет выделений отключен, а RSS - если он недоступен.
+ * @param csv Поток CSV-файла.
+ * @param memory Статистика этапа.
+ */
+void writeAllocationCsvFields(std::ostream& csv, const AllocationStats& memory) {
+    csv << ",";
+    if (allocationTrackingEnabled()) csv << memory.allocations << "," << memory.bytes << "," << memory.peakExtraBytes;
+    else csv << ",,";
+    csv << ",";
+    if (memory.peakRssBytes != 0) csv << memory.peakRssBytes;
+}
+
+
+/**
+ * @brief Статистика по серии замеров времени одной сортировки.
+ */
+struct TimingStats {
+    int repetitions = 0;    ///< Количество замеренных запусков (без прогревочных)
+    double minMs = 0.0;     ///< Минимальное время (мс)
+    double medianMs = 0.0;  ///< Медиана (мс)
+    double p95Ms = 0.0;     ///< 95-й перцентиль (мс)
+    double meanMs = 0.0;    ///< Среднее (мс)
+    double stddevMs = 0.0;  ///< Выборочное стандартное отклонение (мс)
+    OperationCounts operations;  ///< Счетчики операций последнего запуска (в режиме инструментирования)
+    HardwareCounts hardware;     ///< Средние значения аппаратных счетчиков за замеряемый запуск
+    AllocationStats loadMemory;  ///< Выделения при загрузке набора (заполняет вызывающий код, одно значение на набор)
+    AllocationStats copyMemory;  ///< Выделения при копировании данных перед запуском (максимум по замеряемым запускам)
+    AllocationStats sortMemory;  ///< Выделения во время сортировки (максимум по замеряемым запускам)
+};
+
+
+/**
+ * @brief Вычисляет статистику по набору замеров.
+ * @param samples Замеры времени в миллисекундах (будут отсортированы).
+ * @return Минимум, медиана, 95-й перцентиль (по ближайшему рангу), среднее и стандартное отклонение.
+ */
+TimingStats computeTimingStats(std::vector<double>& samples) {
+    TimingStats stats;
+    stats.repetitions = static_cast<int>(samples.size());
+    if (samples.empty()) return stats;
+
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    stats.minMs = samples.front();
+    stats.medianMs = (n % 2 == 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+    size_t rank = static_cast<size_t>(std::ceil(0.95 * n));
+    stats.p95Ms = samples[std::max<size_t>(rank, 1) - 1];
+
+    double sum = 0.0;
+    for (double sample : samples) sum += sample;
+    stats.meanMs = sum / n;
+    if (n > 1) {
+        double squares = 0.0;
+        for (double sample : samples) squares += (sample - stats.meanMs) * (sample - stats.meanMs);
+        stats.stddevMs = std::sqrt(squares / (n - 1));
+    }
+    return stats;
+}
+
+
+/**
+ * @brief Измеряет время выполнения заданной функции сортировки по серии запусков.
+ * Перед каждым запуском данные копируются вне замеряемого интервала; первые warmupRuns
+ * запусков не учитываются. Время измеряется по std::chrono::steady_clock.
+ * Счетчики операций и выделений памяти сбрасываются после копирования, поэтому учитывают только саму сортировку;
+ * выделения при копировании учитываются отдельно (copyMemory).
+ * @tparam SortFunc Тип функции сортировки (например, void(*)(std::vector<Service>&)).
+ * @tparam Dataset Тип набора данных (std::vector<Service> или ServiceTable).
+ * @param sortFunction Функция сортировки для измерения времени.
+ * @param data Набор данных для сортировки (копируется перед каждым запуском).
+ * @param algorithmName Название алгоритма для вывода.
+ * @param warmupRuns Количество прогревочных запусков.
+ * @param repetitions Количество замеряемых запусков (не меньше 1).
+ * @param counters Аппаратные счетчики, снимаемые вокруг каждого замеряемого запуска (nullptr - не собирать).
+ * @return Статистика времени сортировки в миллисекундах.
+ */
+template<typename SortFunc, typename Dataset>
+TimingStats timeSort(SortFunc sortFunction, const Dataset& data, const std::string& algorithmName,
+                     int warmupRuns, int repetitions, HardwareCounters* counters = nullptr) {
+    (void)algorithmName;
+    repetitions = std::max(1, repetitions);
+    std::vector<double> samples;
+    samples.reserve(repetitions);
+    OperationCounts operations;
+    HardwareCounts hardware;
+    AllocationStats copyMemory;
+    AllocationStats sortMemory;
+    for (int run = 0; run < warmupRuns + repetitions; ++run) {
+        bool measured = run >= warmupRuns;
+        std::optional<AllocationScope> copyScope;
+        if (measured) copyScope.emplace();
+        Dataset dataCopy = data;
+        if (measured) copyMemory.combineMax(copyScope->stats());
+        resetOperationCounters();
+        std::optional<AllocationScope> sortScope;
+        if (measured) sortScope.emplace();
+        if (counters && measured) counters->start();
+        auto start = std::chrono::steady_clock::now();
+        sortFunction(dataCopy);
+        auto end = std::chrono::steady_clock::now();
+        if (counters && measured) {
+            HardwareCounts runCounts = counters->stop();
+            for (size_t i = 0; i < runCounts.values.size(); ++i) {
+                hardware.available[i] = runCounts.available[i];
+                hardware.values[i] += runCounts.values[i] / repetitions;
+            }
+        }
+        operations = readOperationCounters();
+        if (measured) {
+            sortMemory.combineMax(sortScope->stats());
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+    }
+    TimingStats stats = computeTimingStats(samples);
+    stats.operations = operations;
+    stats.hardware = hardware;
+    stats.copyMemory = copyMemory;
+    stats.sortMemory = sortMemory;
+    return stats;
+}
+
+
+/**
+ * @brief Выводит результат замера в консоль и записывает строку в CSV с результатами.
+ * @param timingFile Поток CSV-файла с результатами замеров.
+ * @param datasetSize Размер набора данных.
+ * @param algorithmName Название алгоритма.
+ * @param threads Количество потоков, с которым выполнялась сортировка.
+ * @param stats Статистика замеров.
+ * @param distribution Распределение входных данных (столбец Distribution).
+ */
+void reportTiming(std::ostream& timingFile, size_t datasetSize, const std::string& algorithmName,
+                  unsigned threads, const TimingStats& stats,
+                  DatasetDistribution distribution = DatasetDistribution::Random) {
+    std::cout << algorithmName;
+    if (threads != 1) std::cout << " (" << threads << " потоков)";
+    if (distribution != DatasetDistribution::Random) std::cout << " [" << distributionName(distribution) << "]";
+    std::cout << " завершена за " << std::fixed << std::setprecision(4) << stats.medianMs
+              << " мс (медиана из " << stats.repetitions << ", мин. " << stats.minMs
+              << ", p95 " << stats.p95Ms << ", ст. откл. " << stats.stddevMs << ")";
+    if (allocationTrackingEnabled()) {
+        std::cout << ", доп. память " << std::setprecision(1) << stats.sortMemory.peakExtraBytes / 1024.0 << " КБ"
+                  << " (выделений: " << stats.sortMemory.allocations << ")" << std::setprecision(4);
+    }
+    std::cout << "." << std::endl;
+    if (stats.operations.enabled) {
+        std::cout << "  сравнений: " << stats.operations.comparisons << ", обменов: " << stats.operations.swaps
+                  << ", перемещений: " << stats.operations.moves << std::endl;
+    }
+    if (stats.hardware.available[HardwareCounts::Cycles]) {
+        std::cout << "  тактов: " << std::setprecision(0) << stats.hardware.values[HardwareCounts::Cycles];
+        if (stats.hardware.available[HardwareCounts::Instructions]) {
+            std::cout << ", инструкций: " << stats.hardware.values[HardwareCounts::Instructions];
+        }
+        if (stats.hardware.available[HardwareCounts::LLCMisses]) {
+            std::cout << ", промахов LLC: " << stats.hardware.values[HardwareCounts::LLCMisses];
+        }
+        if (stats.hardware.available[HardwareCounts::BranchMisses]) {
+            std::cout << ", ошибок предсказания переходов: " << stats.hardware.values[HardwareCounts::BranchMisses];
+        }
+        std::cout << std::setprecision(4) << std::endl;
+    }
+    timingFile << datasetSize << "," << distributionName(distribution) << "," << "\"" << algorithmName << "\"" << "," << threads << "," << stats.repetitions << ","
+               << std::fixed << std::setprecision(4) << stats.medianMs << "," << stats.minMs << ","
+               << stats.medianMs << "," << stats.p95Ms << "," << stats.stddevMs << ",";
+    if (stats.operations.enabled) {
+        timingFile << stats.operations.comparisons << "," << stats.operations.swaps << "," << stats.operations.moves;
+    } else {
+        timingFile << ",,";
+    }
+    timingFile << std::setprecision(0);
+    for (size_t i = 0; i < stats.hardware.values.size(); ++i) {
+        timingFile << ",";
+        if (stats.hardware.available[i]) timingFile << stats.hardware.values[i];
+    }
+    for (const AllocationStats* memory : {&stats.loadMemory, &stats.copyMemory, &stats.sortMemory}) {
+        writeAllocationCsvFields(timingFile, *memory);
+    }
+    timingFile << buildDescriptionCsvFields() << "\n";
+}
+
+
+#ifdef SORT_BENCH_HAVE_CUDA
+/**
+ * @brief Выводит медианное время этапов GPU-сортировки и записывает строку в CSV.
+ * Передача данных (извлечение, upload, download, перестановка) отделена от сортировки на устройстве,
+ * чтобы по нескольким размерам можно было найти точку окупаемости относительно CPU-сортировок.
+ * @param gpuFile Поток CSV-файла (заголовок DatasetSize,ExtractMs,UploadMs,KernelMs,DownloadMs,PermuteMs,TransferMs,TotalMs).
+ * @param datasetSize Размер набора данных.
+ * @param runs Время этапов в замеряемых запусках.
+ */
+void reportGpuTiming(std::ostream& gpuFile, size_t datasetSize, const std::vector<GpuSortTimings>& runs) {
+    if (runs.empty()) return;
+    auto median = [&runs](double GpuSortTimings::*field) {
+        std::vector<double> samples;
+        for (const auto& run : runs) samples.push_back(run.*field);
+        return computeTimingStats(samples).medianMs;
+    };
+    double extractMs = median(&GpuSortTimings::extractMs);
+    double uploadMs = median(&GpuSortTimings::uploadMs);
+    double kernelMs = median(&GpuSortTimings::kernelMs);
+    double downloadMs = median(&GpuSortTimings::downloadMs);
+    double permuteMs = median(&GpuSortTimings::permuteMs);
+    double transferMs = uploadMs + downloadMs;
+    double totalMs = extractMs + transferMs + kernelMs + permuteMs;
+    std::cout << "GPU: передача " << std::fixed << std::setprecision(4) << transferMs << " мс (upload " << uploadMs
+              << ", download " << downloadMs << "), сортировка на устройстве " << kernelMs << " мс, хост "
+              << extractMs + permuteMs << " мс." << std::endl;
+    gpuFile << datasetSize << "," << std::fixed << std::setprecision(4) << extractMs << "," << uploadMs << "," << kernelMs << ","
+            << downloadMs << "," << permuteMs << "," << transferMs << "," << totalMs << "\n";
+}
+#endif
+
+
+/**
+ * @brief Измеряет время загрузки CSV-файла быстрым загрузчиком (mmap + std::from_chars).
+ * @param filename Путь к CSV-файлу.
+ * @param loadedCount Количество прочитанных записей (выходной параметр).
+ * @return Время загрузки в миллисекундах, включая отображение файла в память.
+ * @throws std::runtime_error Если файл не удается открыть.
+ */
+double timeMappedLoad(const std::string& filename, size_t& loadedCount) {
+    std::vector<ServiceView> views;
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(filename);
+    loadServicesMapped(file, views);
+    auto end = std::chrono::steady_clock::now();
+    loadedCount = views.size();
+    std::chrono::duration<double, std::milli> duration_ms = end - start;
+    return duration_ms.count();
+}
+
+
+/**
+ * @brief Измеряет время параллельной загрузки CSV-файла (mmap + разбор по частям в нескольких потоках).
+ * @param filename Путь к CSV-файлу.
+ * @param threadCount Количество потоков разбора.
+ * @param loadedCount Количество прочитанных записей (выходной параметр).
+ * @param fileBytes Размер файла в байтах (выходной параметр).
+ * @return Время загрузки в миллисекундах, включая отображение файла в память.
+ * @throws std::runtime_error Если файл не удается открыть.
+ */
+double timeParallelLoad(const std::string& filename, unsigned threadCount, size_t& loadedCount, size_t& fileBytes) {
+    std::vector<ServiceView> views;
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(filename);
+    loadServicesParallel(file, views, threadCount);
+    auto end = std::chrono::steady_clock::now();
+    loadedCount = views.size();
+    fileBytes = file.size();
+    std::chrono::duration<double, std::milli> duration_ms = end - start;
+    return duration_ms.count();
+}
+
+
+/**
+ * @brief Измеряет время загрузки бинарного столбцового файла (mmap, проверка контрольной суммы, построение ServiceView).
+ * @param filename Путь к бинарному файлу.
+ * @param loadedCount Количество прочитанных записей (выходной параметр, 0 - файл некорректен).
+ * @param fileBytes Размер файла в байтах (выходной параметр).
+ * @return Время загрузки в миллисекундах.
+ * @throws std::runtime_error Если файл не удается открыть.
+ */
+double timeBinaryLoad(const std::string& filename, size_t& loadedCount, size_t& fileBytes) {
+    std::vector<ServiceView> views;
+    auto start = std::chrono::steady_clock::now();
+    BinaryDataset dataset(filename);
+    dataset.toViews(views);
+    auto end = std::chrono::steady_clock::now();
+    loadedCount = views.size();
+    fileBytes = dataset.isValid() ? static_cast<size_t>(BinaryDatasetLayout::compute(dataset.size(), dataset.getHeader().namePoolBytes).total) : 0;
+    std::chrono::duration<double, std::milli> duration_ms = end - start;
+    return duration_ms.count();
+}
+
+
+/**
+ * @brief Сравнивает загрузчики на одном файле и записывает строки в CSV с замерами загрузки.
+ * Замеряются loadServices, loadServicesMapped, loadServicesParallel для каждого количества
+ * потоков и загрузка бинарного файла (если он есть). Пропускная способность считается по размеру прочитанного
+ * файла: CSV для текстовых загрузчиков, бинарного файла для BinaryDataset.
+ * @param loadTimingFile Поток CSV-файла с замерами загрузки.
+ * @param filename Путь к CSV-файлу.
+ * @param binaryFilename Путь к бинарному файлу того же набора данных.
+ * @param datasetSize Размер набора данных для записи в CSV.
+ * @param expectedCount Ожидаемое количество записей (для проверки загрузчиков).
+ * @param threadCounts Количества потоков для параллельного загрузчика.
+ */
+void runLoadBenchmark(std::ostream& loadTimingFile, const std::string& filename, const std::string& binaryFilename,
+                      size_t datasetSize, size_t expectedCount, const std::vector<unsigned>& threadCounts) {
+    auto writeRow = [&](const std::string& loader, unsigned threads, double timeMs, size_t bytes) {
+        double throughput = timeMs > 0.0 ? (bytes / 1048576.0) / (timeMs / 1000.0) : 0.0;
+        std::cout << loader;
+        if (threads != 1) std::cout << " (" << threads << " потоков)";
+        std::cout << ": " << std::fixed << std::setprecision(4) << timeMs << " мс, "
+                  << std::setprecision(1) << throughput << " МБ/с." << std::endl;
+        loadTimingFile << datasetSize << "," << "\"" << loader << "\"" << "," << threads << ","
+                       << std::fixed << std::setprecision(4) << timeMs << "," << throughput << "\n";
+    };
+    auto checkCount = [&](const std::string& loader, size_t count) {
+        if (count != expectedCount) {
+            std::cerr << "Предупреждение: " << loader << " прочитал " << count << " записей вместо " << expectedCount << "." << std::endl;
+        }
+    };
+
+    try {
+        std::vector<Service> streamServices;
+        auto start = std::chrono::steady_clock::now();
+        loadServices(filename, streamServices);
+        auto end = std::chrono::steady_clock::now();
+        checkCount("loadServices", streamServices.size());
+
+        size_t mappedCount = 0;
+        double mappedLoadTime = timeMappedLoad(filename, mappedCount);
+        checkCount("loadServicesMapped", mappedCount);
+
+        size_t fileBytes = 0;
+        for (unsigned threads : threadCounts) {
+            size_t parallelCount = 0;
+            double parallelLoadTime = timeParallelLoad(filename, threads, parallelCount, fileBytes);
+            checkCount("loadServicesParallel", parallelCount);
+            writeRow("loadServicesParallel", threads, parallelLoadTime, fileBytes);
+        }
+        writeRow("loadServices", 1, std::chrono::duration<double, std::milli>(end - start).count(), fileBytes);
+        writeRow("loadServicesMapped", 1, mappedLoadTime, fileBytes);
+
+        try {
+            size_t binaryCount = 0;
+            size_t binaryBytes = 0;
+            double binaryLoadTime = timeBinaryLoad(binaryFilename, binaryCount, binaryBytes);
+            checkCount("BinaryDataset", binaryCount);
+            writeRow("BinaryDataset", 1, binaryLoadTime, binaryBytes);
+        } catch (const std::runtime_error&) {
+            // Бинарного файла нет - пропускаем замер.
+        }
+        loadTimingFile.flush();
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+
+/**
+ * @brief Замеряет сильную и слабую масштабируемость параллельных сортировок и записывает строки в CSV.
+ * Сильная масштабируемость - фиксированный размер strongSize при разном числе потоков;
+ * слабая - weakSizePerThread записей на поток. Данные генерируются generateServices() по образцам.
+ * Ускорение и эффективность считаются относительно первого (наименьшего) числа потоков t0.
+ * Пул потоков создается до замеров каждой точки, поэтому его запуск и остановка в замер не входят.
+ * @param scalingFile Поток CSV-файла (заголовок Mode,Algorithm,Threads,DatasetSize,TimeMilliseconds,Speedup,Efficiency).
+ * @param templates Записи-образцы для генератора.
+ * @param strongSize Размер набора для сильной масштабируемости.
+ * @param weakSizePerThread Размер на поток для слабой масштабируемости.
+ * @param threadCounts Количества потоков (положительные, по возрастанию).
+ * @param repetitions Замеряемые запуски на точку.
+ */
+void runScalingBenchmark(std::ostream& scalingFile, const std::vector<Service>& templates, size_t strongSize,
+                         size_t weakSizePerThread, const std::vector<unsigned>& threadCounts, int repetitions) {
+    using SortFunction = std::function<void(std::vector<Service>&, WorkStealingPool&)>;
+    const std::vector<std::pair<std::string, SortFunction>> algorithms = {
+        {"Параллельная выборочная сортировка", [](std::vector<Service>& vec, WorkStealingPool& pool) { parallelSampleSort(vec, std::less<Service>(), pool); }},
+        {"Параллельная сортировка слиянием", [](std::vector<Service>& vec, WorkStealingPool& pool) { parallelMergeSort(vec, pool); }},
+    };
+
+    auto runMode = [&](const std::string& mode, bool weak) {
+        std::vector<Service> data;
+        if (!weak) {
+            std::cout << "Генерация " << strongSize << " записей для сильной масштабируемости..." << std::endl;
+            data = generateServices(templates, strongSize);
+        }
+        std::map<std::string, double> baselineMs;
+        for (unsigned threads : threadCounts) {
+            if (weak) {
+                data = generateServices(templates, weakSizePerThread * threads);
+            }
+            WorkStealingPool pool(threads - 1);
+            for (const auto& [name, sortFunction] : algorithms) {
+                TimingStats stats = timeSort([&sortFunction, &pool](std::vector<Service>& vec) { sortFunction(vec, pool); },
+                                             data, name, 0, repetitions);
+                if (threads == threadCounts.front()) baselineMs[name] = stats.medianMs;
+                double relative = stats.medianMs > 0.0 ? baselineMs[name] / stats.medianMs : 0.0;
+                double scale = static_cast<double>(threads) / threadCounts.front();
+                // Сильная: ускорение T(t0) / T(t). Слабая: эффективность T(t0) / T(t) (идеал - постоянное время).
+                double speedup = weak ? relative * scale : relative;
+                double efficiency = weak ? relative : relative / scale;
+                std::cout << mode << ", " << name << ", " << threads << " потоков, " << data.size() << " записей: "
+                          << std::fixed << std::setprecision(4) << stats.medianMs << " мс, ускорение "
+                          << std::setprecision(2) << speedup << ", эффективность " << efficiency << std::endl;
+                scalingFile << mode << ",\"" << name << "\"," << threads << "," << data.size() << ","
+                            << std::fixed << std::setprecision(4) << stats.medianMs << "," << speedup << "," << efficiency << "\n";
+            }
+        }
+        scalingFile.flush();
+    };
+
+    runMode("strong", false);
+    runMode("weak", true);
+}
+
+
+/**
+ * @brief Возвращает значения K для замеров выборки: 10, 100, 1000, ... меньше n/2 и сам n/2.
+ * @param n Размер набора данных.
+ */
+std::vector<size_t> topKBenchmarkSizes(size_t n) {
+    std::vector<size_t> ks;
+    for (size_t k = 10; k < n / 2; k *= 10) ks.push_back(k);
+    if (n / 2 > 0) ks.push_back(n / 2);
+    return ks;
+}
+
+
+/**
+ * @brief Сравнивает выборку k наименьших записей с полной сортировкой для K от 10 до n/2.
+ * В памяти: полная std::sort, ограниченная куча, nth_element + сортировка и std::partial_sort.
+ * Из файла: потоковая куча topKStreaming против потокового чтения всего файла и полной сортировки.
+ * Ускорение считается относительно полной сортировки с тем же источником данных.
+ * @param topKFile Поток CSV-файла (заголовок DatasetSize,K,Source,Method,TimeMilliseconds,SpeedupVsFullSort).
+ * @param csvFilename CSV-файл набора данных.
+ * @param data Тот же набор, загруженный в память.
+ * @param repetitions Замеряемые запуски на точку.
+ */
+void runTopKBenchmark(std::ostream& topKFile, const std::string& csvFilename, const std::vector<Service>& data, int repetitions) {
+    auto report = [&](size_t k, const std::string& source, const std::string& method, double ms, double fullSortMs) {
+        double speedup = ms > 0.0 ? fullSortMs / ms : 0.0;
+        std::cout << "K=" << k << ", " << source << ", " << method << ": " << std::fixed << std::setprecision(4) << ms
+                  << " мс, ускорение относительно полной сортировки " << std::setprecision(2) << speedup << std::endl;
+        topKFile << data.size() << "," << k << "," << source << "," << method << ","
+                 << std::fixed << std::setprecision(4) << ms << "," << speedup << "\n";
+    };
+
+    double fullSortMs = timeSort([](std::vector<Service>& vec) { std::sort(vec.begin(), vec.end()); },
+                                 data, "std::sort", 1, repetitions).medianMs;
+    double streamFullSortMs = timeSort([](std::string& path) {
+        std::vector<Service> all;
+        streamServices(path, 1u << 20, [&all](const ServiceView& view) {
+            all.emplace_back(std::string(view.name), view.cost, view.duration, view.prepayment);
+        });
+        std::sort(all.begin(), all.end());
+    }, csvFilename, "std::sort", 1, repetitions).medianMs;
+
+    std::vector<Service> result;
+    for (size_t k : topKBenchmarkSizes(data.size())) {
+        report(k, "memory", "full_sort", fullSortMs, fullSortMs);
+        report(k, "memory", "heap", timeSort([k, &result](std::vector<Service>& vec) { result = topKHeap(vec, k); },
+                                             data, "heap", 1, repetitions).medianMs, fullSortMs);
+        report(k, "memory", "nth_element", timeSort([k](std::vector<Service>& vec) { topKSelect(vec, k); },
+                                                    data, "nth_element", 1, repetitions).medianMs, fullSortMs);
+        report(k, "memory", "partial_sort", timeSort([k](std::vector<Service>& vec) { topKPartialSort(vec, k); },
+                                                     data, "partial_sort", 1, repetitions).medianMs, fullSortMs);
+        report(k, "file", "full_sort", streamFullSortMs, streamFullSortMs);
+        report(k, "file", "streaming_heap", timeSort([k, &result](std::string& path) { topKStreaming(path, k, result); },
+                                                     csvFilename, "streaming_heap", 1, repetitions).medianMs, streamFullSortMs);
+    }
+    topKFile.flush();
+}
+
+
+/**
+ * @brief Замеряет сортировку по одной спецификации: универсальный компаратор против SortSpec.
+ * Методы: runtime_comparator (std::sort с makeRuntimeComparator), spec_comparator (std::sort с SortSpec),
+ * spec_key_sort (specKeySort) и spec_radix (specRadixSort). Ускорение - относительно runtime_comparator.
+ * @tparam Spec Спецификация SortSpec.
+ * @param specFile Поток CSV-файла (заголовок DatasetSize,Spec,Method,TimeMilliseconds,SpeedupVsRuntime).
+ * @param data Набор данных.
+ * @param warmupRuns Прогревочные запуски.
+ * @param repetitions Замеряемые запуски.
+ */
+template<typename Spec>
+void benchmarkSortSpec(std::ostream& specFile, const std::vector<Service>& data, int warmupRuns, int repetitions) {
+    const std::string spec = Spec::description();
+    auto runtimeComparator = makeRuntimeComparator(parseSortSpec(spec));
+    using SortFunction = std::function<void(std::vector<Service>&)>;
+    const std::vector<std::pair<std::string, SortFunction>> methods = {
+        {"runtime_comparator", [&runtimeComparator](std::vector<Service>& vec) { std::sort(vec.begin(), vec.end(), runtimeComparator); }},
+        {"spec_comparator", [](std::vector<Service>& vec) { std::sort(vec.begin(), vec.end(), Spec()); }},
+        {"spec_key_sort", [](std::vector<Service>& vec) { specKeySort<Spec>(vec); }},
+        {"spec_radix", [](std::vector<Service>& vec) { specRadixSort<Spec>(vec); }},
+    };
+
+    double runtimeMs = 0.0;
+    for (const auto& [method, sortFunction] : methods) {
+        double ms = timeSort(sortFunction, data, method, warmupRuns, repetitions).medianMs;
+        if (method == "runtime_comparator") runtimeMs = ms;
+        double speedup = ms > 0.0 ? runtimeMs / ms : 0.0;
+        std::cout << "[" << spec << "] " << method << ": " << std::fixed << std::setprecision(4) << ms
+                  << " мс, ускорение " << std::setprecision(2) << speedup << std::endl;
+        specFile << data.size() << ",\"" << spec << "\"," << method << ","
+                 << std::fixed << std::setprecision(4) << ms << "," << speedup << "\n";
+    }
+    specFile.flush();
+}
+
+
+/**
+ * @brief Замеряет сортировку по спецификациям KnownSortSpecs (см. benchmarkSortSpec).
+ */
+void runSortSpecBenchmark(std::ostream& specFile, const std::vector<Service>& data, int warmupRuns, int repetitions) {
+    std::apply([&](auto... specs) {
+        (benchmarkSortSpec<decltype(specs)>(specFile, data, warmupRuns, repetitions), ...);
+    }, KnownSortSpecs());
+}
+
+
+/**
+ * @brief Сравнивает пакетное обновление SortedServiceIndex с полной пересортировкой после каждого пакета.
+ * В режиме insert каждый пакет - batchSize новых записей (generateServices), в режиме insert_delete
+ * дополнительно удаляется batchSize / 2 исходных записей. Пересортировка дописывает пакет в вектор,
+ * выполняет std::sort и удаляет записи одним проходом std::set_difference. Время делится на количество пакетов.
+ * @param indexFile Поток CSV-файла (заголовок DatasetSize,BatchSize,Batches,Operation,Method,TotalMs,MsPerBatch,SpeedupVsResort).
+ * @param data Исходный набор данных.
+ * @param batchSizes Размеры пакетов.
+ * @param batches Количество пакетов на замер.
+ */
+void runSortedIndexBenchmark(std::ostream& indexFile, const std::vector<Service>& data,
+                             const std::vector<size_t>& batchSizes, size_t batches) {
+    std::vector<size_t> deleteOrder(data.size());
+    for (size_t i = 0; i < deleteOrder.size(); ++i) deleteOrder[i] = i;
+    std::shuffle(deleteOrder.begin(), deleteOrder.end(), std::mt19937_64(2024));
+
+    for (size_t batchSize : batchSizes) {
+        std::vector<std::vector<Service>> inserts;
+        for (size_t b = 0; b < batches; ++b) {
+            inserts.push_back(generateServices(data, batchSize, 7 + b));
+        }
+        for (bool withDeletes : {false, true}) {
+            std::vector<std::vector<Service>> deletes(batches);
+            size_t deleteSize = withDeletes ? batchSize / 2 : 0;
+            for (size_t b = 0; b < batches; ++b) {
+                for (size_t i = 0; i < deleteSize && b * deleteSize + i < deleteOrder.size(); ++i) {
+                    deletes[b].push_back(data[deleteOrder[b * deleteSize + i]]);
+                }
+            }
+
+            SortedServiceIndex index(data);
+            auto start = std::chrono::steady_clock::now();
+            for (size_t b = 0; b < batches; ++b) {
+                index.insertBatch(inserts[b]);
+                if (withDeletes) index.eraseBatch(deletes[b]);
+            }
+            double indexMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::vector<Service> resorted = data;
+            std::sort(resorted.begin(), resorted.end());
+            start = std::chrono::steady_clock::now();
+            for (size_t b = 0; b < batches; ++b) {
+                resorted.insert(resorted.end(), inserts[b].begin(), inserts[b].end());
+                std::sort(resorted.begin(), resorted.end());
+                if (!deletes[b].empty()) {
+                    std::vector<Service> removed = deletes[b];
+                    std::sort(removed.begin(), removed.end());
+                    std::vector<Service> kept;
+                    kept.reserve(resorted.size());
+                    std::set_difference(std::make_move_iterator(resorted.begin()), std::make_move_iterator(resorted.end()),
+                                        removed.begin(), removed.end(), std::back_inserter(kept));
+                    resorted.swap(kept);
+                }
+            }
+            double resortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            const char* operation = withDeletes ? "insert_delete" : "insert";
+            for (const auto& [method, totalMs] : {std::make_pair("sorted_index", indexMs), std::make_pair("full_resort", resortMs)}) {
+                double perBatch = totalMs / batches;
+                double speedup = totalMs > 0.0 ? resortMs / totalMs : 0.0;
+                std::cout << operation << ", пакет " << batchSize << ", " << method << ": " << std::fixed << std::setprecision(4)
+                          << perBatch << " мс на пакет, ускорение " << std::setprecision(2) << speedup
+                          << (method == std::string("sorted_index") ? " (серий: " + std::to_string(index.runCount()) + ")" : "") << std::endl;
+                indexFile << data.size() << "," << batchSize << "," << batches << "," << operation << "," << method << ","
+                          << std::fixed << std::setprecision(4) << totalMs << "," << perBatch << "," << speedup << "\n";
+            }
+        }
+    }
+    indexFile.flush();
+}
+
+
+/**
+ * @brief Сравнивает сортировку с предвычисленными ключами названий (CollatedServices) и обычными компараторами.
+ *
+ * Входные данные: random - набор как есть; tied - стоимость и предоплата округлены до 5000, поэтому
+ * порядок в основном определяют названия. Для каждого режима сопоставления (binary, russian) замеряются
+ * comparator (std::sort с Service::operator< или russianCollationLess) и cached_prefix (collatedSort);
+ * для russian дополнительно std_locale - std::collate локали ru_RU.UTF-8, если она установлена.
+ * KeyBuildMs - однократное построение ключей при загрузке (CollatedServices::fromServices).
+ * @param collationFile Поток CSV-файла (заголовок DatasetSize,Input,Collation,Method,TimeMilliseconds,KeyBuildMs,SpeedupVsComparator).
+ * @param data Набор данных.
+ * @param warmupRuns Прогревочные запуски.
+ * @param repetitions Замеряемые запуски.
+ */
+void runCollationBenchmark(std::ostream& collationFile, const std::vector<Service>& data, int warmupRuns, int repetitions) {
+    std::optional<std::locale> russianLocale;
+    try {
+        russianLocale.emplace("ru_RU.UTF-8");
+    } catch (const std::runtime_error&) {
+        std::cerr << "Предупреждение: Локаль ru_RU.UTF-8 не установлена, замер std_locale пропущен." << std::endl;
+    }
+
+    std::vector<Service> tied = data;
+    for (auto& s : tied) {
+        s.cost = std::round(s.cost / 5000.0) * 5000.0;
+        s.prepayment = std::round(s.prepayment / 5000.0) * 5000.0;
+    }
+
+    using Input = std::pair<const char*, const std::vector<Service>*>;
+    for (const auto& [input, services] : {Input("random", &data), Input("tied", &tied)}) {
+        for (NameCollation collation : {NameCollation::Binary, NameCollation::Russian}) {
+            auto buildStart = std::chrono::steady_clock::now();
+            CollatedServices collated = CollatedServices::fromServices(*services, collation);
+            double keyBuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+            double comparatorMs = 0.0;
+            auto report = [&](const char* method, double ms, double buildMs) {
+                double speedup = ms > 0.0 ? comparatorMs / ms : 0.0;
+                std::cout << "[" << input << ", " << nameCollationName(collation) << "] " << method << ": "
+                          << std::fixed << std::setprecision(4) << ms << " мс";
+                if (buildMs > 0.0) std::cout << " (+" << buildMs << " мс на ключи)";
+                std::cout << ", ускорение " << std::setprecision(2) << speedup << std::endl;
+                collationFile << services->size() << "," << input << "," << nameCollationName(collation) << "," << method << ","
+                              << std::fixed << std::setprecision(4) << ms << "," << buildMs << "," << speedup << "\n";
+            };
+
+            if (collation == NameCollation::Binary) {
+                comparatorMs = timeSort([](std::vector<Service>& vec) { std::sort(vec.begin(), vec.end()); },
+                                        *services, "comparator", warmupRuns, repetitions).medianMs;
+            } else {
+                comparatorMs = timeSort([](std::vector<Service>& vec) { std::sort(vec.begin(), vec.end(), russianCollationLess); },
+                                        *services, "comparator", warmupRuns, repetitions).medianMs;
+            }
+            report("comparator", comparatorMs, 0.0);
+            report("cached_prefix", timeSort([](CollatedServices& set) { collatedSort(set); },
+                                             collated, "cached_prefix", warmupRuns, repetitions).medianMs, keyBuildMs);
+
+            if (collation == NameCollation::Russian && russianLocale) {
+                const auto& collate = std::use_facet<std::collate<char>>(*russianLocale);
+                auto localeLess = [&collate](const Service& a, const Service& b) {
+                    if (a.cost != b.cost) return a.cost < b.cost;
+                    if (a.prepayment != b.prepayment) return a.prepayment < b.prepayment;
+                    return collate.compare(a.name.data(), a.name.data() + a.name.size(),
+                                           b.name.data(), b.name.data() + b.name.size()) < 0;
+                };
+                report("std_locale", timeSort([&localeLess](std::vector<Service>& vec) { std::sort(vec.begin(), vec.end(), localeLess); },
+                                              *services, "std_locale", warmupRuns, repetitions).medianMs, 0.0);
+            }
+        }
+    }
+    collationFile.flush();
+}
+
+
+/**
+ * @brief Сравнивает совмещенную сортировку с редукцией (fusedSortReduce) с тремя отдельными проходами
+ * (sortUniqueAggregate) на наборах с дубликатами.
+ * Входные данные: random - набор как есть, duplicated - половина записей заменена копиями случайных записей,
+ * few_unique - makeDatasetVariant(FewUnique).
+ * @param reduceFile Поток CSV-файла (заголовок DatasetSize,Input,Method,UniqueRecords,Buckets,TimeMilliseconds,SpeedupVsSeparate).
+ * @param data Набор данных.
+ * @param bucketWidth Ширина корзины стоимости.
+ * @param warmupRuns Прогревочные запуски.
+ * @param repetitions Замеряемые запуски.
+ */
+void runSortReduceBenchmark(std::ostream& reduceFile, const std::vector<Service>& data, double bucketWidth,
+                            int warmupRuns, int repetitions) {
+    std::vector<Service> duplicated = data;
+    std::mt19937 random(4242);
+    if (!data.empty()) {
+        std::uniform_int_distribution<size_t> pick(0, data.size() - 1);
+        for (auto& service : duplicated) {
+            if (random() % 2) service = data[pick(random)];
+        }
+    }
+    std::vector<Service> fewUnique = makeDatasetVariant(data, DatasetDistribution::FewUnique);
+
+    using Input = std::pair<const char*, const std::vector<Service>*>;
+    for (const auto& [input, services] : {Input("random", &data), Input("duplicated", &duplicated), Input("few_unique", &fewUnique)}) {
+        size_t uniqueRecords = 0;
+        std::vector<CostBucketAggregate> aggregates;
+        double separateMs = 0.0;
+        auto report = [&](const char* method, double ms) {
+            double speedup = ms > 0.0 ? separateMs / ms : 0.0;
+            std::cout << "[" << input << "] " << method << ": " << std::fixed << std::setprecision(4) << ms << " мс, "
+                      << uniqueRecords << " различных записей, " << aggregates.size() << " корзин, ускорение "
+                      << std::setprecision(2) << speedup << std::endl;
+            reduceFile << services->size() << "," << input << "," << method << "," << uniqueRecords << "," << aggregates.size() << ","
+                       << std::fixed << std::setprecision(4) << ms << "," << speedup << "\n";
+        };
+        separateMs = timeSort([&](std::vector<Service>& vec) { sortUniqueAggregate(vec, bucketWidth, aggregates); uniqueRecords = vec.size(); },
+                              *services, "sort_unique_aggregate", warmupRuns, repetitions).medianMs;
+        report("sort_unique_aggregate", separateMs);
+        double fusedMs = timeSort([&](std::vector<Service>& vec) { fusedSortReduce(vec, bucketWidth, aggregates); uniqueRecords = vec.size(); },
+                                  *services, "fused_sort_reduce", warmupRuns, repetitions).medianMs;
+        report("fused_sort_reduce", fusedMs);
+    }
+    reduceFile.flush();
+}
+
+
+/**
+ * @brief Нагрузочный тест SortService: clients потоков-клиентов отправляют задания смешанных размеров
+ * (100, 1000, 10000 записей и весь набор с весами 50/30/15/5%; каждое четвертое - со спецификацией
+ * "duration,-cost") и ждут результата. Режимы: adaptive (маленькие задания - в вызывающем потоке,
+ * большие делятся между рабочими) и single_task (каждое задание - одна задача пула).
+ * Задержка - от submit() до готовности результата; она раскладывается на средние ожидание в очереди
+ * и выполнение (SortJobResult::queueMs, runMs). Строка cancel - время от cancel() до готовности
+ * результата большого задания.
+ * @param serviceFile Поток CSV-файла (заголовок Mode,Workers,Clients,JobSize,Jobs,Completed,Expired,P50Ms,P99Ms,MeanMs,
+ * MeanQueueMs,MeanRunMs,JobsPerSecond).
+ * @param data Набор данных (источник заданий).
+ * @param workers Рабочих потоков сервиса.
+ * @param clients Потоков-клиентов.
+ * @param jobsPerClient Заданий на клиента.
+ * @param deadlineMs Срок выполнения задания (0 - без срока).
+ */
+void runSortServiceBenchmark(std::ostream& serviceFile, const std::vector<Service>& data, unsigned workers,
+                             size_t clients, size_t jobsPerClient, double deadlineMs) {
+    if (data.empty()) return;
+    using Clock = SortService::Clock;
+    struct Sample {
+        size_t size;
+        double latencyMs;
+        double queueMs;
+        double runMs;
+        SortJobStatus status;
+    };
+    const std::vector<size_t> jobSizes = {std::min<size_t>(100, data.size()), std::min<size_t>(1000, data.size()),
+                                          std::min<size_t>(10000, data.size()), data.size()};
+    const std::vector<double> jobWeights = {50, 30, 15, 5};
+
+    auto report = [&](const char* mode, unsigned workerCount, const std::string& jobSize, std::vector<Sample> samples, double wallMs) {
+        if (samples.empty()) return;
+        std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.latencyMs < b.latencyMs; });
+        auto percentile = [&samples](double q) {
+            size_t rank = static_cast<size_t>(std::ceil(q * samples.size()));
+            return samples[std::max<size_t>(rank, 1) - 1].latencyMs;
+        };
+        size_t completed = 0;
+        size_t expired = 0;
+        double totalMs = 0.0;
+        double queueMs = 0.0;
+        double runMs = 0.0;
+        for (const auto& sample : samples) {
+            completed += sample.status == SortJobStatus::Completed;
+            expired += sample.status == SortJobStatus::DeadlineExceeded;
+            totalMs += sample.latencyMs;
+            queueMs += sample.queueMs;
+            runMs += sample.runMs;
+        }
+        double jobsPerSecond = wallMs > 0.0 ? samples.size() * 1000.0 / wallMs : 0.0;
+        std::cout << mode << ", задания " << jobSize << ": " << samples.size() << " шт., p50 " << std::fixed << std::setprecision(4)
+                  << percentile(0.5) << " мс, p99 " << percentile(0.99) << " мс, в среднем очередь " << queueMs / samples.size()
+                  << " мс, выполнение " << runMs / samples.size() << " мс";
+        if (expired) std::cout << ", просрочено " << expired;
+        std::cout << ", " << std::setprecision(1) << jobsPerSecond << " заданий/с" << std::endl;
+        serviceFile << mode << "," << workerCount << "," << clients << "," << jobSize << "," << samples.size() << "," << completed << ","
+                    << expired << "," << std::fixed << std::setprecision(4) << percentile(0.5) << "," << percentile(0.99) << ","
+                    << totalMs / samples.size() << "," << queueMs / samples.size() << "," << runMs / samples.size() << ","
+                    << std::setprecision(1) << jobsPerSecond << "\n";
+    };
+
+    for (const auto& [mode, adaptive] : {std::make_pair("adaptive", true), std::make_pair("single_task", false)}) {
+        SortService service(workers, adaptive ? SORT_SERVICE_INLINE_THRESHOLD : 0,
+                            adaptive ? SORT_SERVICE_SPLIT_THRESHOLD : std::numeric_limits<size_t>::max());
+        std::vector<std::vector<Sample>> clientSamples(clients);
+        auto wallStart = Clock::now();
+        std::vector<std::thread> clientThreads;
+        for (size_t c = 0; c < clients; ++c) {
+            clientThreads.emplace_back([&, c]() {
+                std::mt19937 random(static_cast<uint32_t>(1000 + c));
+                std::discrete_distribution<size_t> pickSize(jobWeights.begin(), jobWeights.end());
+                for (size_t j = 0; j < jobsPerClient; ++j) {
+                    size_t size = jobSizes[pickSize(random)];
+                    size_t offset = std::uniform_int_distribution<size_t>(0, data.size() - size)(random);
+                    std::vector<Service> job(data.begin() + offset, data.begin() + offset + size);
+                    auto submitted = Clock::now();
+                    auto deadline = deadlineMs > 0.0
+                        ? submitted + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(deadlineMs))
+                        : Clock::time_point::max();
+                    SortJob handle = service.submit(std::move(job), j % 4 == 3 ? "duration,-cost" : "", deadline);
+                    SortJobResult result = handle.result.get();
+                    double latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - submitted).count();
+                    clientSamples[c].push_back({size, latencyMs, result.queueMs, result.runMs, result.status});
+                }
+            });
+        }
+        for (auto& thread : clientThreads) thread.join();
+        double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - wallStart).count();
+
+        std::vector<Sample> all;
+        for (const auto& samples : clientSamples) all.insert(all.end(), samples.begin(), samples.end());
+        for (size_t size : std::set<size_t>(jobSizes.begin(), jobSizes.end())) {
+            std::vector<Sample> sized;
+            std::copy_if(all.begin(), all.end(), std::back_inserter(sized), [size](const Sample& s) { return s.size == size; });
+            report(mode, service.workerCount(), std::to_string(size), sized, wallMs);
+        }
+        report(mode, service.workerCount(), "all", all, wallMs);
+
+        if (adaptive) {
+            SortJob handle = service.submit(data);
+            auto cancelled = Clock::now();
+            handle.cancel();
+            SortJobResult result = handle.result.get();
+            double latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - cancelled).count();
+            std::cout << "Отмена задания из " << data.size() << " записей: итог " << sortJobStatusName(result.status) << "." << std::endl;
+            report("cancel", service.workerCount(), std::to_string(data.size()), {{data.size(), latencyMs, result.queueMs, result.runMs, result.status}}, 0.0);
+        }
+    }
+    serviceFile.flush();
+}
+
+
+/**
+ * @brief Калибрует пороги autoSort на данных, сгенерированных по образцу (generateServices).
+ * Для каждого размера замеряется медианное время на один набор (маленькие наборы сортируются пакетами,
+ * чтобы замер был не короче ~65 тыс. записей); порог - размер, на котором альтернатива становится быстрее:
+ * insertionMaxSize - последний размер, где вставки не медленнее adaptiveSort (с допуском 5% на шум замеров); radixMinSize - первый, где
+ * radixSort быстрее adaptiveSort; parallelMinSize - первый, где parallelSampleSort быстрее лучшего из них
+ * (при одном потоке он не замеряется). Если альтернатива не выиграла ни на одном размере, порог
+ * отключает ее. Незамеренные пороги - предупорядоченности, повторов, размера файла, а при одном потоке
+ * и parallelMinSize - остаются по умолчанию.
+ * @param templates Записи-образцы.
+ * @param threads Потоков для параллельной сортировки.
+ * @param repetitions Замеряемые запуски на размер.
+ * @return Откалиброванные пороги.
+ */
+AutoSortThresholds tuneAutoSort(const std::vector<Service>& templates, unsigned threads, int repetitions) {
+    AutoSortThresholds thresholds;
+    const size_t BATCH_RECORDS = 1u << 16;
+    using Batch = std::vector<std::vector<Service>>;
+    auto makeBatch = [&](size_t size) {
+        size_t count = std::max<size_t>(1, BATCH_RECORDS / size);
+        std::vector<Service> records = generateServices(templates, size * count, 7 + size);
+        Batch batch(count);
+        for (size_t i = 0; i < count; ++i) {
+            batch[i].assign(records.begin() + i * size, records.begin() + (i + 1) * size);
+        }
+        return batch;
+    };
+    auto measure = [&](const Batch& batch, const char* name, auto sortFunction) {
+        double ms = timeSort([&sortFunction](Batch& sets) { for (auto& set : sets) sortFunction(set); },
+                             batch, name, 1, repetitions).medianMs / batch.size();
+        return ms;
+    };
+    auto insertion = [](std::vector<Service>& v) { hybridInsertionSort(v.begin(), v.end(), std::less<Service>()); };
+    auto hybrid = [](std::vector<Service>& v) { adaptiveSort(v); };
+    auto radix = [](std::vector<Service>& v) { radixSort(v); };
+
+    for (size_t size : {8, 12, 16, 24, 32, 48, 64, 96, 128}) {
+        Batch batch = makeBatch(size);
+        double insertionMs = measure(batch, "insertion", insertion);
+        double hybridMs = measure(batch, "hybrid", hybrid);
+        std::cout << "Размер " << size << ": вставки " << std::fixed << std::setprecision(6) << insertionMs
+                  << " мс, гибридная " << hybridMs << " мс." << std::endl;
+        if (insertionMs > hybridMs * 1.05) break;
+        thresholds.insertionMaxSize = size;
+    }
+
+    thresholds.radixMinSize = std::numeric_limits<size_t>::max();
+    for (size_t size = 256; size <= (1u << 18); size *= 2) {
+        Batch batch = makeBatch(size);
+        double hybridMs = measure(batch, "hybrid", hybrid);
+        double radixMs = measure(batch, "radix", radix);
+        std::cout << "Размер " << size << ": гибридная " << std::fixed << std::setprecision(4) << hybridMs
+                  << " мс, поразрядная " << radixMs << " мс." << std::endl;
+        if (radixMs < hybridMs) {
+            thresholds.radixMinSize = size;
+            break;
+        }
+    }
+
+    if (threads > 1) {
+        thresholds.parallelMinSize = std::numeric_limits<size_t>::max();
+        WorkStealingPool pool(threads - 1);
+        for (size_t size = 1u << 15; size <= (1u << 20); size *= 2) {
+            Batch batch = makeBatch(size);
+            double sequentialMs = measure(batch, size >= thresholds.radixMinSize ? "radix" : "hybrid",
+                                          [&](std::vector<Service>& v) { size >= thresholds.radixMinSize ? radixSort(v) : adaptiveSort(v); });
+            double parallelMs = measure(batch, "parallel", [&pool](std::vector<Service>& v) { parallelSampleSort(v, std::less<Service>(), pool); });
+            std::cout << "Размер " << size << ": последовательная " << std::fixed << std::setprecision(4) << sequentialMs
+                      << " мс, параллельная (" << threads << " потоков) " << parallelMs << " мс." << std::endl;
+            if (parallelMs < sequentialMs) {
+                thresholds.parallelMinSize = size;
+                break;
+            }
+        }
+    }
+    return thresholds;
+}
+
+
+/**
+ * @brief Записывает запись в компактном двоичном виде для передачи между узлами:
+ * cost (double), prepayment (double), duration (int32), длина названия (uint32), байты названия.
+ * Порядок байт - родной, поэтому узлы должны иметь одинаковую архитектуру.
+ * @param out Буфер, в конец которого дописывается запись.
+ * @param service Запись.
+ */
+void encodeServiceRecord(std::vector<char>& out, const ServiceView& service) {
+    int32_t duration = service.duration;
+    uint32_t nameSize = static_cast<uint32_t>(service.name.size());
+    size_t offset = out.size();
+    out.resize(offset + 2 * sizeof(double) + sizeof(int32_t) + sizeof(uint32_t) + nameSize);
+    char* p = out.data() + offset;
+    std::memcpy(p, &service.cost, sizeof(double));
+    std::memcpy(p + 8, &service.prepayment, sizeof(double));
+    std::memcpy(p + 16, &duration, sizeof(int32_t));
+    std::memcpy(p + 20, &nameSize, sizeof(uint32_t));
+    std::memcpy(p + 24, service.name.data(), nameSize);
+}
+
+
+/**
+ * @brief Разбирает записи, закодированные encodeServiceRecord, и дописывает их в services.
+ * @param data Начало буфера.
+ * @param size Размер буфера в байтах.
+ * @param services Вектор, в конец которого добавляются записи.
+ * @return True, если буфер разобран целиком, false - если последняя запись обрезана.
+ */
+bool decodeServiceRecords(const char* data, size_t size, std::vector<Service>& services) {
+    const size_t fixedBytes = 2 * sizeof(double) + sizeof(int32_t) + sizeof(uint32_t);
+    size_t offset = 0;
+    while (offset < size) {
+        if (size - offset < fixedBytes) return false;
+        const char* p = data + offset;
+        Service s;
+        int32_t duration;
+        uint32_t nameSize;
+        std::memcpy(&s.cost, p, sizeof(double));
+        std::memcpy(&s.prepayment, p + 8, sizeof(double));
+        std::memcpy(&duration, p + 16, sizeof(int32_t));
+        std::memcpy(&nameSize, p + 20, sizeof(uint32_t));
+        if (size - offset - fixedBytes < nameSize) return false;
+        s.duration = duration;
+        s.name.assign(p + fixedBytes, nameSize);
+        services.push_back(std::move(s));
+        offset += fixedBytes + nameSize;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Выбирает границы диапазонов стоимости по объединенной выборке всех узлов.
+ * @param samples Выборка стоимостей (сортируется внутри).
+ * @param parts Количество диапазонов.
+ * @return parts - 1 неубывающих границ (меньше, если выборка пуста).
+ */
+std::vector<double> chooseCostSplitters(std::vector<double> samples, size_t parts) {
+    std::vector<double> splitters;
+    if (samples.empty() || parts < 2) return splitters;
+    std::sort(samples.begin(), samples.end());
+    for (size_t i = 1; i < parts; ++i) {
+        splitters.push_back(samples[i * samples.size() / parts]);
+    }
+    return splitters;
+}
+
+
+/**
+ * @brief Возвращает номер диапазона для стоимости: записи с равной стоимостью всегда попадают в один
+ * диапазон, поэтому конкатенация отсортированных диапазонов упорядочена по Service::operator<.
+ */
+inline size_t costPartition(const std::vector<double>& splitters, double cost) {
+    return std::upper_bound(splitters.begin(), splitters.end(), cost) - splitters.begin();
+}
+
+
+/**
+ * @brief Количество стоимостей, которое каждый узел вносит в выборку на один диапазон.
+ */
+const size_t DISTRIBUTED_SAMPLES_PER_PART = 32;
+
+
+/**
+ * @brief Показатели распределенной сортировки на одном узле.
+ */
+struct DistributedSortStats {
+    uint64_t loadedRecords = 0;    ///< Записей в шарде узла
+    uint64_t outputRecords = 0;    ///< Записей в выходной части узла
+    uint64_t bytesSent = 0;        ///< Отправлено другим узлам (без собственной части)
+    uint64_t bytesReceived = 0;    ///< Получено от других узлов
+    double loadMs = 0.0;           ///< Загрузка шарда
+    double sampleMs = 0.0;         ///< Выборка и обмен границами диапазонов
+    double partitionMs = 0.0;      ///< Разбиение и кодирование записей
+    double exchangeMs = 0.0;       ///< Обмен записями
+    double sortMs = 0.0;           ///< Разбор полученных записей и локальная сортировка
+    double saveMs = 0.0;           ///< Запись выходной части
+};
+
+
+#ifdef SORT_BENCH_HAVE_MPI
+/**
+ * @brief Распределенная сортировка разбиением по диапазонам стоимости (MPI).
+ *
+ * Каждый узел загружает свой шард быстрым загрузчиком (loadServicesMapped), вносит равномерную выборку
+ * стоимостей, по объединенной выборке все узлы выбирают одинаковые границы, разбивают записи по диапазонам,
+ * обмениваются ими в компактном двоичном виде (MPI_Alltoallv), сортируют полученное и сохраняют свою часть:
+ * части в порядке номеров узлов образуют отсортированный каталог.
+ * @param comm Коммуникатор узлов.
+ * @param shardFilename CSV-файл шарда узла.
+ * @param stripe Если true, файл общий для всех узлов, и узел берет из него свою непрерывную долю записей.
+ * @param outputFilename Файл выходной части узла.
+ * @param stats Показатели узла (выходной параметр).
+ * @return True, если часть сохранена успешно.
+ * @throws std::runtime_error Если файл не удается открыть или объем обмена с узлом превышает 2 ГБ.
+ */
+bool distributedSort(MPI_Comm comm, const std::string& shardFilename, bool stripe,
+                     const std::string& outputFilename, DistributedSortStats& stats) {
+    int rank = 0;
+    int ranks = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &ranks);
+    stats = DistributedSortStats();
+    auto elapsedMs = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    MappedFile file(shardFilename);
+    std::vector<ServiceView> views;
+    loadServicesMapped(file, views);
+    if (stripe) {
+        size_t first = views.size() * rank / ranks;
+        size_t last = views.size() * (rank + 1) / ranks;
+        views = std::vector<ServiceView>(views.begin() + first, views.begin() + last);
+    }
+    stats.loadedRecords = views.size();
+    stats.loadMs = elapsedMs(start);
+    MPI_Barrier(comm);
+
+    start = std::chrono::steady_clock::now();
+    size_t sampleCount = std::min(views.size(), DISTRIBUTED_SAMPLES_PER_PART * ranks);
+    std::vector<double> localSamples;
+    for (size_t i = 0; i < sampleCount; ++i) {
+        localSamples.push_back(views[i * views.size() / sampleCount].cost);
+    }
+    int localSampleCount = static_cast<int>(localSamples.size());
+    std::vector<int> sampleCounts(ranks);
+    MPI_Allgather(&localSampleCount, 1, MPI_INT, sampleCounts.data(), 1, MPI_INT, comm);
+    std::vector<int> sampleOffsets(ranks, 0);
+    for (int r = 1; r < ranks; ++r) sampleOffsets[r] = sampleOffsets[r - 1] + sampleCounts[r - 1];
+    std::vector<double> samples(sampleOffsets[ranks - 1] + sampleCounts[ranks - 1]);
+    MPI_Allgatherv(localSamples.data(), localSampleCount, MPI_DOUBLE,
+                   samples.data(), sampleCounts.data(), sampleOffsets.data(), MPI_DOUBLE, comm);
+    std::vector<double> splitters = chooseCostSplitters(std::move(samples), ranks);
+    stats.sampleMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<char>> outgoing(ranks);
+    for (const auto& view : views) {
+        encodeServiceRecord(outgoing[costPartition(splitters, view.cost)], view);
+    }
+    std::vector<int> sendCounts(ranks);
+    std::vector<int> sendOffsets(ranks, 0);
+    std::vector<char> sendBuffer;
+    for (int r = 0; r < ranks; ++r) {
+        if (outgoing[r].size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("Ошибка: Объем данных для узла " + std::to_string(r) + " превышает 2 ГБ.");
+        }
+        sendCounts[r] = static_cast<int>(outgoing[r].size());
+        sendOffsets[r] = static_cast<int>(sendBuffer.size());
+        sendBuffer.insert(sendBuffer.end(), outgoing[r].begin(), outgoing[r].end());
+        if (r != rank) stats.bytesSent += outgoing[r].size();
+        std::vector<char>().swap(outgoing[r]);
+    }
+    stats.partitionMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<int> receiveCounts(ranks);
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, receiveCounts.data(), 1, MPI_INT, comm);
+    std::vector<int> receiveOffsets(ranks, 0);
+    size_t receiveBytes = 0;
+    for (int r = 0; r < ranks; ++r) {
+        if (receiveBytes > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("Ошибка: Объем данных, получаемых узлом " + std::to_string(rank) + ", превышает 2 ГБ.");
+        }
+        receiveOffsets[r] = static_cast<int>(receiveBytes);
+        receiveBytes += receiveCounts[r];
+        if (r != rank) stats.bytesReceived += receiveCounts[r];
+    }
+    std::vector<char> receiveBuffer(receiveBytes);
+    MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendOffsets.data(), MPI_CHAR,
+                  receiveBuffer.data(), receiveCounts.data(), receiveOffsets.data(), MPI_CHAR, comm);
+    stats.exchangeMs = elapsedMs(start);
+    std::vector<char>().swap(sendBuffer);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<Service> partition;
+    if (!decodeServiceRecords(receiveBuffer.data(), receiveBuffer.size(), partition)) {
+        std::cerr << "Ошибка: Узел " << rank << " получил поврежденные данные." << std::endl;
+        return false;
+    }
+    std::vector<char>().swap(receiveBuffer);
+    std::sort(partition.begin(), partition.end());
+    stats.outputRecords = partition.size();
+    stats.sortMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    bool saved = saveServicesFast(outputFilename, partition);
+    stats.saveMs = elapsedMs(start);
+    return saved;
+}
+
+
+/**
+ * @brief Собирает показатели всех узлов на узле 0, выводит их и записывает в CSV.
+ * @param comm Коммуникатор узлов.
+ * @param stats Показатели текущего узла.
+ * @param csvFilename Файл результатов (заголовок Rank,Ranks,LoadedRecords,OutputRecords,BytesSent,BytesReceived,
+ *                    LoadMs,SampleMs,PartitionMs,ExchangeMs,SortMs,SaveMs); записывается только узлом 0.
+ */
+void reportDistributedSort(MPI_Comm comm, const DistributedSortStats& stats, const std::string& csvFilename) {
+    int rank = 0;
+    int ranks = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &ranks);
+    const int FIELDS = 10;
+    const double local[FIELDS] = {
+        static_cast<double>(stats.loadedRecords), static_cast<double>(stats.outputRecords),
+        static_cast<double>(stats.bytesSent), static_cast<double>(stats.bytesReceived),
+        stats.loadMs, stats.sampleMs, stats.partitionMs, stats.exchangeMs, stats.sortMs, stats.saveMs
+    };
+    std::vector<double> all(rank == 0 ? FIELDS * ranks : 0);
+    MPI_Gather(local, FIELDS, MPI_DOUBLE, all.data(), FIELDS, MPI_DOUBLE, 0, comm);
+    if (rank != 0) return;
+
+    std::ofstream csv(csvFilename, std::ios::binary);
+    csv << "Rank,Ranks,LoadedRecords,OutputRecords,BytesSent,BytesReceived,LoadMs,SampleMs,PartitionMs,ExchangeMs,SortMs,SaveMs\n";
+    for (int r = 0; r < ranks; ++r) {
+        const double* v = &all[FIELDS * r];
+        std::cout << "Узел " << r << ": " << static_cast<uint64_t>(v[0]) << " -> " << static_cast<uint64_t>(v[1])
+                  << " записей, отправлено " << static_cast<uint64_t>(v[2]) << " байт, получено " << static_cast<uint64_t>(v[3])
+                  << " байт, обмен " << std::fixed << std::setprecision(4) << v[7] << " мс, сортировка " << v[8] << " мс." << std::endl;
+        csv << r << "," << ranks;
+        for (int i = 0; i < 4; ++i) csv << "," << static_cast<uint64_t>(v[i]);
+        for (int i = 4; i < FIELDS; ++i) csv << "," << std::fixed << std::setprecision(4) << v[i];
+        csv << "\n";
+    }
+    std::cout << "Результаты распределенной сортировки сохранены в " << csvFilename << "." << std::endl;
+}
+#endif
+
+
+/**
+ * @brief Ограниченная по размеру потокобезопасная очередь между стадиями конвейера.
+ * push() блокируется, пока очередь заполнена и не закрыта, pop() - пока она пуста и не закрыта.
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(std::max<size_t>(capacity, 1)) {}
+
+    /**
+     * @brief Добавляет элемент, ожидая освобождения места.
+     * @return False, если очередь закрыта (элемент отбрасывается).
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this]() { return items.size() < capacity || closed; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Извлекает элемент.
+     * @return Элемент или std::nullopt, если очередь закрыта и пуста.
+     */
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this]() { return !items.empty() || closed; });
+        if (items.empty()) return std::nullopt;
+        T item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return item;
+    }
+
+    /**
+     * @brief Сообщает, что новых элементов не будет; ожидающие push() возвращают false.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    size_t capacity;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    bool closed = false;
+};
+
+
+/**
+ * @brief Задание для конвейера загрузка -> сортировка -> сохранение.
+ */
+struct PipelineJob {
+    std::string csvFilename;     ///< Исходный CSV-файл.
+    std::string binaryFilename;  ///< Бинарная копия (используется, если актуальна; может быть пустой).
+    std::string outputFilename;  ///< Файл для отсортированного результата.
+};
+
+
+/**
+ * @brief Результаты прогона конвейера.
+ * Загруженность стадии - доля общего времени, которую стадия провела в работе, а не в ожидании очередей.
+ */
+struct PipelineStats {
+    size_t datasets = 0;     ///< Успешно обработанные наборы данных.
+    size_t records = 0;      ///< Общее количество отсортированных записей.
+    double wallMs = 0.0;     ///< Общее время от начала первой загрузки до окончания последней записи.
+    double loadBusyMs = 0.0;
+    double sortBusyMs = 0.0;
+    double saveBusyMs = 0.0;
+
+    double loadUtilization() const { return wallMs > 0.0 ? loadBusyMs / wallMs : 0.0; }
+    double sortUtilization() const { return wallMs > 0.0 ? sortBusyMs / wallMs : 0.0; }
+    double saveUtilization() const { return wallMs > 0.0 ? saveBusyMs / wallMs : 0.0; }
+};
+
+
+/**
+ * @brief Загружает набор данных для конвейера: из актуального бинарного файла, иначе из CSV.
+ * @return True, если загружена хотя бы одна запись.
+ */
+bool loadPipelineDataset(const PipelineJob& job, std::vector<Service>& services) {
+    try {
+        if (!job.binaryFilename.empty() && loadServicesBinary(job.binaryFilename, job.csvFilename, services)) {
+            return true;
+        }
+        return loadServices(job.csvFilename, services);
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+}
+
+
+/**
+ * @brief Обрабатывает задания конвейером: поток чтения загружает следующий набор данных,
+ * пока текущий сортируется, а поток записи параллельно сохраняет отсортированные результаты.
+ * Стадии связаны очередями BoundedQueue емкостью queueCapacity, так что в памяти одновременно
+ * находится не больше (2 * queueCapacity + 3) наборов данных. Исключение любой стадии закрывает
+ * обе очереди, остальные стадии завершаются, потоки присоединяются, и исключение передается вызывающему.
+ * @param jobs Задания в порядке обработки.
+ * @param sortFunction Функция сортировки, принимающая std::vector<Service>&; выполняется в вызывающем потоке.
+ * @param queueCapacity Емкость каждой из очередей между стадиями.
+ * @param stats Заполняется временем и загруженностью стадий.
+ * @return True, если все задания загружены и сохранены успешно.
+ * @throws Первое исключение, выброшенное сортировкой или стадиями чтения и записи.
+ */
+template<typename SortFunc>
+bool runPipeline(const std::vector<PipelineJob>& jobs, SortFunc sortFunction, size_t queueCapacity, PipelineStats& stats) {
+    using Clock = std::chrono::steady_clock;
+    struct Batch {
+        const PipelineJob* job;
+        std::vector<Service> services;
+    };
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    stats = PipelineStats();
+    BoundedQueue<Batch> loaded(queueCapacity);
+    BoundedQueue<Batch> sorted(queueCapacity);
+    std::atomic<bool> allOk{true};
+    std::exception_ptr failure;   // Первое исключение стадий
+    std::mutex failureMutex;
+    auto fail = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) failure = std::current_exception();
+        }
+        loaded.close();
+        sorted.close();
+    };
+    auto start = Clock::now();
+
+    std::thread reader([&]() {
+        try {
+            for (const auto& job : jobs) {
+                auto loadStart = Clock::now();
+                Batch batch{&job, {}};
+                bool ok = loadPipelineDataset(job, batch.services);
+                stats.loadBusyMs += elapsedMs(loadStart);
+                if (!ok) {
+                    std::cerr << "Конвейер: пропуск " << job.csvFilename << " из-за ошибки загрузки или пустого файла." << std::endl;
+                    allOk = false;
+                    continue;
+                }
+                if (!loaded.push(std::move(batch))) break;
+            }
+        } catch (...) {
+            fail();
+        }
+        loaded.close();
+    });
+
+    std::thread writer([&]() {
+        try {
+            while (auto batch = sorted.pop()) {
+                auto saveStart = Clock::now();
+                bool ok = false;
+                try {
+                    ok = saveServicesFast(batch->job->outputFilename, batch->services);
+                } catch (const std::runtime_error& e) {
+                    std::cerr << e.what() << std::endl;
+                }
+                stats.saveBusyMs += elapsedMs(saveStart);
+                if (!ok) allOk = false;
+            }
+        } catch (...) {
+            fail();
+        }
+    });
+
+    try {
+        while (auto batch = loaded.pop()) {
+            auto sortStart = Clock::now();
+            sortFunction(batch->services);
+            stats.sortBusyMs += elapsedMs(sortStart);
+            ++stats.datasets;
+            stats.records += batch->services.size();
+            if (!sorted.push(std::move(*batch))) break;
+        }
+    } catch (...) {
+        fail();
+    }
+    sorted.close();
+    loaded.close();   // Поток чтения не должен ждать места в очереди, которую больше никто не читает
+
+    reader.join();
+    writer.join();
+    if (failure) std::rethrow_exception(failure);
+    stats.wallMs = elapsedMs(start);
+    return allOk;
+}
+
+
+/**
+ * @brief Обрабатывает те же задания последовательно (загрузка, сортировка, сохранение одного набора
+ * за другим) - базовая линия для сравнения с runPipeline().
+ */
+template<typename SortFunc>
+bool runSequentialPipeline(const std::vector<PipelineJob>& jobs, SortFunc sortFunction, PipelineStats& stats) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    stats = PipelineStats();
+    bool allOk = true;
+    auto start = Clock::now();
+    for (const auto& job : jobs) {
+        std::vector<Service> services;
+        auto loadStart = Clock::now();
+        bool ok = loadPipelineDataset(job, services);
+        stats.loadBusyMs += elapsedMs(loadStart);
+        if (!ok) {
+            allOk = false;
+            continue;
+        }
+        auto sortStart = Clock::now();
+        sortFunction(services);
+        stats.sortBusyMs += elapsedMs(sortStart);
+        auto saveStart = Clock::now();
+        try {
+            if (!saveServicesFast(job.outputFilename, services)) allOk = false;
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            allOk = false;
+        }
+        stats.saveBusyMs += elapsedMs(saveStart);
+        ++stats.datasets;
+        stats.records += services.size();
+    }
+    stats.wallMs = elapsedMs(start);
+    return allOk;
+}
+
+
+/**
+ * @brief Выводит результаты прогона конвейера в консоль и строку CSV.
  */
-void shakerSort(std::vector<Service>& arr) {
-    int n = arr.size();
-    bool swapped = true;
-    int start = 0;
-    int end = n - 1;
+void reportPipeline(std::ostream& pipelineFile, const std::string& mode, size_t queueCapacity, const PipelineStats& stats) {
+    std::cout << mode << ": " << stats.datasets << " наборов, " << stats.records << " записей, "
+              << std::fixed << std::setprecision(4) << stats.wallMs << " мс; загруженность стадий: чтение "
+              << std::setprecision(1) << stats.loadUtilization() * 100.0 << "%, сортировка "
+              << stats.sortUtilization() * 100.0 << "%, запись " << stats.saveUtilization() * 100.0 << "%." << std::endl;
+    pipelineFile << "\"" << mode << "\"," << queueCapacity << "," << stats.datasets << "," << stats.records << ","
+                 << std::fixed << std::setprecision(4) << stats.wallMs << "," << stats.loadBusyMs << ","
+                 << stats.sortBusyMs << "," << stats.saveBusyMs << "," << stats.loadUtilization() << ","
+                 << stats.sortUtilization() << "," << stats.saveUtilization() << "\n";
+}
 
-    while (swapped) {
-        swapped = false;
-        for (int i = start; i < end; ++i) {
-            if (arr[i] > arr[i + 1]) {
-                std::swap(arr[i], arr[i + 1]);
-                swapped = true;
-            }
+
+/**
+ * @brief Идентификаторы алгоритмов для параметра --algorithms и их названия в результатах.
+ */
+const std::vector<std::pair<std::string, std::string>> BENCHMARK_ALGORITHMS = {
+    {"bubble", "Сортировка пузырьком"},
+    {"insertion", "Сортировка вставками"},
+    {"shaker", "Шейкер-сортировка"},
+    {"std_sort", "std::sort"},
+    {"key_sort", "std::sort (извлеченные ключи)"},
+    {"radix", "Поразрядная сортировка"},
+    {"adaptive", "Адаптивная гибридная сортировка"},
+    {"stable_std", "std::stable_sort"},
+    {"stable_merge", "Стабильное слияние (буфер сохраняется)"},
+    {"stable_inplace", "Стабильное слияние на месте"},
+    {"simd", "SIMD-сортировка"},
+    {"pooled", "std::sort (арена названий)"},
+    {"soa", "std::sort (SoA)"},
+    {"soa_radix", "Поразрядная сортировка (SoA)"},
+    {"par_std", "std::sort (par_unseq)"},
+    {"par_merge", "Параллельная сортировка слиянием"},
+    {"sample", "Параллельная выборочная сортировка"},
+    {"gpu", "Поразрядная сортировка (GPU)"},
+    {"auto", "Автовыбор алгоритма (autoSort)"},
+};
+
+
+/**
+ * @brief Параметры запуска замеров. Значения по умолчанию воспроизводят полный прогон.
+ * Задаются аргументами командной строки вида --ключ=значение или файлом конфигурации (--config=файл)
+ * со строками "ключ = значение"; см. printBenchmarkUsage().
+ */
+struct BenchmarkConfig {
+    std::vector<int> datasetSizes = {
+        100, 8100, 16100, 24100, 32100, 40100, 48100,
+        56100, 64100, 72100, 80100, 88100, 96100
+    };
+    std::string datasetsDir = "datasets/";
+    std::string filenamePattern = "it_services_dataset_diverse_";
+    std::string binaryExtension = ".svcb";
+    std::string resultsDir = "results/";
+
+    std::vector<std::string> algorithms;   ///< Идентификаторы из BENCHMARK_ALGORITHMS; пусто - все
+    int warmupRuns = 2;                    ///< Прогревочные запуски для быстрых сортировок
+    int repetitions = 10;                  ///< Замеряемые запуски для быстрых сортировок
+    int quadraticWarmupRuns = 0;           ///< Для O(n^2) сортировок прогрев слишком дорог
+    int quadraticRepetitions = 3;
+    std::vector<unsigned> threadCounts;    ///< Пусто - 1, 2, 4, 8, 16 и число аппаратных потоков
+    double timeBudgetMs = 0.0;             ///< Бюджет на один алгоритм и размер (прогрев + замеры); 0 - без ограничения
+
+    bool collectHardwareCounters = true;   ///< Снимать аппаратные счетчики вокруг каждого запуска
+    bool runLoadBenchmark = true;
+    bool runDistributionBenchmark = true;  ///< Замеры на почти отсортированных, развернутых и повторяющихся данных
+    bool runSaveBenchmark = true;
+    bool runExternalSort = true;
+    bool runPipelineBenchmark = true;      ///< Сравнить последовательную и конвейерную обработку всех наборов
+    size_t pipelineQueueCapacity = 2;      ///< Наборов данных в каждой очереди между стадиями
+    bool runScalingBenchmark = true;       ///< Сильная и слабая масштабируемость на сгенерированных данных
+    size_t scalingSize = 10000000;         ///< Размер для сильной масштабируемости (и наибольший для слабой)
+    int scalingRepetitions = 3;
+    std::vector<size_t> generateSizes;     ///< Если задано - только сгенерировать наборы этих размеров
+    bool runTopKBenchmark = true;          ///< Выборка K наименьших записей против полной сортировки
+    size_t topKQuery = 0;                  ///< Если больше 0 - только сохранить K самых дешевых услуг каждого набора
+    bool runSortSpecBenchmark = true;      ///< Спецификации SortSpec против универсального компаратора
+    bool runSortedIndexBenchmark = true;   ///< Пакетные обновления SortedServiceIndex против полной пересортировки
+    std::vector<size_t> indexBatchSizes = {10, 100, 1000};
+    size_t indexBatches = 32;              ///< Пакетов на замер
+    bool runCollationBenchmark = true;     ///< Предвычисленные ключи названий (binary и russian) против компараторов
+    bool runSortReduceBenchmark = true;    ///< Совмещенная сортировка с удалением дубликатов и агрегатами
+    double costBucketWidth = DEFAULT_COST_BUCKET_WIDTH;   ///< Ширина корзины стоимости для агрегатов
+    bool runSortServiceBenchmark = true;   ///< Нагрузочный тест асинхронного SortService
+    unsigned serviceWorkers = 0;           ///< Рабочих потоков SortService (0 - по числу аппаратных потоков)
+    size_t serviceClients = 4;             ///< Потоков-клиентов нагрузочного теста
+    size_t serviceJobs = 200;              ///< Заданий на клиента
+    double serviceDeadlineMs = 0.0;        ///< Срок выполнения задания (0 - без срока)
+    std::string autoSortConfigFile = "auto_sort.cfg";   ///< Пороги autoSort
+    bool tuneAutoSort = false;             ///< Только откалибровать пороги autoSort и записать их в autoSortConfigFile
+    bool runDistributedSort = false;       ///< Только распределенная сортировка (запуск через mpirun, сборка с SORT_BENCH_WITH_MPI)
+    std::string distributedShardPattern;   ///< Файл шарда узла, {rank} заменяется номером; пусто - доли наибольшего набора
+    ExternalSortConfig externalSort = []() {
+        ExternalSortConfig config;
+        config.memoryBudgetBytes = 4u << 20;   // Заведомо меньше самого большого набора, чтобы получить несколько серий
+        return config;
+    }();
+
+    /**
+     * @brief Проверяет, выбран ли алгоритм для замеров.
+     */
+    bool algorithmEnabled(const std::string& id) const {
+        return algorithms.empty() || std::find(algorithms.begin(), algorithms.end(), id) != algorithms.end();
+    }
+};
+
+
+/**
+ * @brief Выводит справку по параметрам командной строки.
+ */
+void printBenchmarkUsage(std::ostream& os, const char* program) {
+    os << "Использование: " << program << " [--ключ=значение ...]\n"
+       << "  --config=ФАЙЛ                 файл со строками \"ключ = значение\" (# - комментарий); те же ключи без --\n"
+       << "  --sizes=N,N,...               размеры наборов данных\n"
+       << "  --algorithms=ID,ID,...        алгоритмы (all - все):";
+    for (const auto& algorithm : BENCHMARK_ALGORITHMS) os << " " << algorithm.first;
+    os << "\n"
+       << "  --reps=N, --warmup=N          замеры и прогревочные запуски быстрых сортировок\n"
+       << "  --quadratic-reps=N, --quadratic-warmup=N   то же для O(n^2) сортировок\n"
+       << "  --threads=N,N,...             количества потоков для параллельных сортировок (0 - число аппаратных потоков);\n"
+       << "                                autoSort и --tune-auto-sort используют наибольшее\n"
+       << "  --time-budget-ms=T            пропускать алгоритм на размерах, где прогноз времени превышает T мс\n"
+       << "  --datasets-dir=DIR, --filename-pattern=P, --results-dir=DIR\n"
+       << "  --hardware-counters=on|off, --load-benchmark=on|off, --distributions=on|off,\n"
+       << "  --save-benchmark=on|off, --external-sort=on|off, --pipeline=on|off\n"
+       << "  --pipeline-queue=N            емкость очередей конвейера\n"
+       << "  --external-memory-mb=M, --external-temp-dir=DIR, --external-fan-in=N\n"
+       << "  --scaling=on|off, --scaling-size=N, --scaling-reps=N   замеры масштабируемости\n"
+       << "  --generate=N,N,...            сгенерировать наборы данных этих размеров по образцу и завершить работу\n"
+       << "  --top-k-benchmark=on|off      замеры выборки K наименьших записей против полной сортировки\n"
+       << "  --top-k=K                     сохранить K самых дешевых услуг каждого набора (потоковое чтение) и завершить работу\n"
+       << "  --sort-spec-benchmark=on|off  замеры многоключевых спецификаций сортировки\n"
+       << "  --sorted-index=on|off, --index-batch-sizes=N,N,..., --index-batches=N   пакетные обновления индекса\n"
+       << "  --collation-benchmark=on|off  замеры сортировки с ключами сопоставления названий\n"
+       << "  --sort-reduce=on|off, --cost-bucket=W   совмещенные сортировка, удаление дубликатов и агрегаты по корзинам стоимости\n"
+       << "  --sort-service=on|off, --service-workers=N, --service-clients=N, --service-jobs=N, --service-deadline-ms=MS\n"
+       << "                                нагрузочный тест асинхронного сервиса сортировки\n"
+       << "  --auto-sort-config=FILE       пороги автовыбора алгоритма (по умолчанию auto_sort.cfg)\n"
+       << "  --tune-auto-sort=on|off       откалибровать пороги автовыбора, записать их в файл порогов и завершить работу\n"
+       << "  --distributed=on|off          распределенная сортировка по диапазонам стоимости (mpirun) и завершить работу\n"
+       << "  --distributed-shards=PATTERN  шард узла, {rank} - номер узла (по умолчанию - доли наибольшего набора)\n"
+       << "  --help                        эта справка\n";
+}
+
+
+/**
+ * @brief Разбирает список значений через запятую.
+ * @throws std::runtime_error Если элемент списка не является числом.
+ */
+template<typename T>
+std::vector<T> parseConfigList(const std::string& key, const std::string& value) {
+    std::vector<T> result;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (item.empty()) continue;
+        T parsed{};
+        auto [ptr, ec] = std::from_chars(item.data(), item.data() + item.size(), parsed);
+        if (ec != std::errc() || ptr != item.data() + item.size()) {
+            throw std::runtime_error("Ошибка: Некорректное значение параметра " + key + ": " + item);
         }
-        if (!swapped) break;
+        result.push_back(parsed);
+    }
+    return result;
+}
 
-        swapped = false;
-        --end;
 
-        for (int i = end - 1; i >= start; --i) {
-            if (arr[i] > arr[i + 1]) {
-                std::swap(arr[i], arr[i + 1]);
-                swapped = true;
-            }
+/**
+ * @brief Разбирает одно числовое значение параметра.
+ * @throws std::runtime_error Если значение не является числом.
+ */
+template<typename T>
+T parseConfigNumber(const std::string& key, const std::string& value) {
+    std::vector<T> values = parseConfigList<T>(key, value);
+    if (values.size() != 1) {
+        throw std::runtime_error("Ошибка: Параметр " + key + " ожидает одно число: " + value);
+    }
+    return values.front();
+}
+
+
+/**
+ * @brief Разбирает логическое значение параметра (on/off, true/false, yes/no, 1/0).
+ * @throws std::runtime_error Если значение не распознано.
+ */
+bool parseConfigBool(const std::string& key, const std::string& value) {
+    if (value == "on" || value == "true" || value == "yes" || value == "1") return true;
+    if (value == "off" || value == "false" || value == "no" || value == "0") return false;
+    throw std::runtime_error("Ошибка: Параметр " + key + " ожидает on или off: " + value);
+}
+
+
+/**
+ * @brief Добавляет завершающий разделитель к пути каталога.
+ */
+std::string withTrailingSlash(std::string directory) {
+    if (!directory.empty() && directory.back() != '/' && directory.back() != '\\') directory += '/';
+    return directory;
+}
+
+
+void loadBenchmarkConfigFile(const std::string& filename, BenchmarkConfig& config);
+
+
+/**
+ * @brief Загружает пороги autoSort из файла (строки "ключ = значение", # - комментарий).
+ * Ключи: insertion-max-size, presorted-max-descent-ratio, duplicate-min-ratio, radix-min-size,
+ * parallel-min-size, external-min-bytes; отсутствующие ключи не изменяются.
+ * @param filename Путь к файлу порогов.
+ * @param thresholds Пороги (выходной параметр).
+ * @return False, если файла нет.
+ * @throws std::runtime_error Если файл содержит некорректную строку или неизвестный ключ.
+ */
+bool loadAutoSortThresholds(const std::string& filename, AutoSortThresholds& thresholds) {
+    std::ifstream file(filename);
+    if (!file.is_open()) return false;
+    auto trim = [](std::string text) {
+        size_t begin = text.find_first_not_of(" \t\r");
+        size_t end = text.find_last_not_of(" \t\r");
+        return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+    };
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        size_t separator = line.find('=');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Ошибка: Некорректная строка в файле порогов " + filename + ": " + line);
+        }
+        std::string key = trim(line.substr(0, separator));
+        std::string value = trim(line.substr(separator + 1));
+        if (key == "insertion-max-size") {
+            thresholds.insertionMaxSize = parseConfigNumber<size_t>(key, value);
+        } else if (key == "presorted-max-descent-ratio") {
+            thresholds.presortedMaxDescentRatio = parseConfigNumber<double>(key, value);
+        } else if (key == "duplicate-min-ratio") {
+            thresholds.duplicateMinRatio = parseConfigNumber<double>(key, value);
+        } else if (key == "radix-min-size") {
+            thresholds.radixMinSize = parseConfigNumber<size_t>(key, value);
+        } else if (key == "parallel-min-size") {
+            thresholds.parallelMinSize = parseConfigNumber<size_t>(key, value);
+        } else if (key == "external-min-bytes") {
+            thresholds.externalMinBytes = parseConfigNumber<uint64_t>(key, value);
+        } else {
+            throw std::runtime_error("Ошибка: Неизвестный порог в файле " + filename + ": " + key);
         }
-        ++start;
     }
+    return true;
 }
 
 
 /**
- * @brief Измеряет время выполнения заданной функции сортировки.
- * @tparam SortFunc Тип функции сортировки (например, void(*)(std::vector<Service>&)).
- * @param sortFunction Функция сортировки для измерения времени.
- * @param data Вектор объектов Service для сортировки (будет скопирован).
- * @param algorithmName Название алгоритма для вывода.
- * @return Продолжительность сортировки в миллисекундах (double).
+ * @brief Сохраняет пороги autoSort в формате loadAutoSortThresholds.
+ * @param filename Путь к файлу порогов.
+ * @param thresholds Пороги.
+ * @param comment Строка комментария в начале файла (например, сведения о сборке).
+ * @return True, если запись прошла успешно.
+ * @throws std::runtime_error Если файл не удается открыть для записи.
  */
-template<typename SortFunc>
-double timeSort(SortFunc sortFunction, const std::vector<Service>& data, const std::string& algorithmName) {
-    std::vector<Service> dataCopy = data;
-    auto start = std::chrono::high_resolution_clock::now();
-    sortFunction(dataCopy);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double, std::milli> duration_ms = end - start;
-    return duration_ms.count();
+bool saveAutoSortThresholds(const std::string& filename, const AutoSortThresholds& thresholds, const std::string& comment) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Ошибка: Не удалось открыть файл порогов для записи: " + filename);
+    }
+    file << "# " << comment << "\n"
+         << "insertion-max-size = " << thresholds.insertionMaxSize << "\n"
+         << "presorted-max-descent-ratio = " << thresholds.presortedMaxDescentRatio << "\n"
+         << "duplicate-min-ratio = " << thresholds.duplicateMinRatio << "\n"
+         << "radix-min-size = " << thresholds.radixMinSize << "\n"
+         << "parallel-min-size = " << thresholds.parallelMinSize << "\n"
+         << "external-min-bytes = " << thresholds.externalMinBytes << "\n";
+    return static_cast<bool>(file);
+}
+
+
+/**
+ * @brief Применяет один параметр к конфигурации.
+ * @param key Имя параметра без "--".
+ * @param value Значение параметра.
+ * @throws std::runtime_error Если параметр неизвестен или значение некорректно.
+ */
+void applyBenchmarkOption(BenchmarkConfig& config, const std::string& key, const std::string& value) {
+    if (key == "config") {
+        loadBenchmarkConfigFile(value, config);
+    } else if (key == "sizes") {
+        config.datasetSizes = parseConfigList<int>(key, value);
+        if (config.datasetSizes.empty()) {
+            throw std::runtime_error("Ошибка: Параметр sizes ожидает хотя бы один размер набора: " + value);
+        }
+    } else if (key == "algorithms") {
+        config.algorithms.clear();
+        if (value == "all") return;
+        std::stringstream ss(value);
+        std::string id;
+        while (std::getline(ss, id, ',')) {
+            id.erase(0, id.find_first_not_of(" \t"));
+            id.erase(id.find_last_not_of(" \t") + 1);
+            if (id.empty()) continue;
+            bool known = std::any_of(BENCHMARK_ALGORITHMS.begin(), BENCHMARK_ALGORITHMS.end(),
+                                     [&id](const auto& algorithm) { return algorithm.first == id; });
+            if (!known) throw std::runtime_error("Ошибка: Неизвестный алгоритм: " + id);
+            config.algorithms.push_back(id);
+        }
+    } else if (key == "reps") {
+        config.repetitions = parseConfigNumber<int>(key, value);
+    } else if (key == "warmup") {
+        config.warmupRuns = parseConfigNumber<int>(key, value);
+    } else if (key == "quadratic-reps") {
+        config.quadraticRepetitions = parseConfigNumber<int>(key, value);
+    } else if (key == "quadratic-warmup") {
+        config.quadraticWarmupRuns = parseConfigNumber<int>(key, value);
+    } else if (key == "threads") {
+        config.threadCounts = parseConfigList<unsigned>(key, value);
+    } else if (key == "time-budget-ms") {
+        config.timeBudgetMs = parseConfigNumber<double>(key, value);
+    } else if (key == "datasets-dir") {
+        config.datasetsDir = withTrailingSlash(value);
+    } else if (key == "filename-pattern") {
+        config.filenamePattern = value;
+    } else if (key == "results-dir") {
+        config.resultsDir = withTrailingSlash(value);
+    } else if (key == "hardware-counters") {
+        config.collectHardwareCounters = parseConfigBool(key, value);
+    } else if (key == "load-benchmark") {
+        config.runLoadBenchmark = parseConfigBool(key, value);
+    } else if (key == "distributions") {
+        config.runDistributionBenchmark = parseConfigBool(key, value);
+    } else if (key == "save-benchmark") {
+        config.runSaveBenchmark = parseConfigBool(key, value);
+    } else if (key == "external-sort") {
+        config.runExternalSort = parseConfigBool(key, value);
+    } else if (key == "pipeline") {
+        config.runPipelineBenchmark = parseConfigBool(key, value);
+    } else if (key == "pipeline-queue") {
+        config.pipelineQueueCapacity = parseConfigNumber<size_t>(key, value);
+    } else if (key == "external-memory-mb") {
+        config.externalSort.memoryBudgetBytes = parseConfigNumber<size_t>(key, value) << 20;
+    } else if (key == "external-temp-dir") {
+        config.externalSort.tempDirectory = value;
+    } else if (key == "external-fan-in") {
+        config.externalSort.maxMergeFanIn = parseConfigNumber<size_t>(key, value);
+    } else if (key == "scaling") {
+        config.runScalingBenchmark = parseConfigBool(key, value);
+    } else if (key == "scaling-size") {
+        config.scalingSize = parseConfigNumber<size_t>(key, value);
+    } else if (key == "scaling-reps") {
+        config.scalingRepetitions = parseConfigNumber<int>(key, value);
+    } else if (key == "generate") {
+        config.generateSizes = parseConfigList<size_t>(key, value);
+    } else if (key == "top-k-benchmark") {
+        config.runTopKBenchmark = parseConfigBool(key, value);
+    } else if (key == "top-k") {
+        config.topKQuery = parseConfigNumber<size_t>(key, value);
+    } else if (key == "sort-spec-benchmark") {
+        config.runSortSpecBenchmark = parseConfigBool(key, value);
+    } else if (key == "sorted-index") {
+        config.runSortedIndexBenchmark = parseConfigBool(key, value);
+    } else if (key == "index-batch-sizes") {
+        config.indexBatchSizes = parseConfigList<size_t>(key, value);
+    } else if (key == "index-batches") {
+        config.indexBatches = parseConfigNumber<size_t>(key, value);
+    } else if (key == "collation-benchmark") {
+        config.runCollationBenchmark = parseConfigBool(key, value);
+    } else if (key == "sort-reduce") {
+        config.runSortReduceBenchmark = parseConfigBool(key, value);
+    } else if (key == "cost-bucket") {
+        config.costBucketWidth = parseConfigNumber<double>(key, value);
+        if (!(config.costBucketWidth > 0.0)) {
+            throw std::runtime_error("Ошибка: Ширина корзины стоимости должна быть положительной: " + value);
+        }
+    } else if (key == "sort-service") {
+        config.runSortServiceBenchmark = parseConfigBool(key, value);
+    } else if (key == "service-workers") {
+        config.serviceWorkers = parseConfigNumber<unsigned>(key, value);
+    } else if (key == "service-clients") {
+        config.serviceClients = parseConfigNumber<size_t>(key, value);
+    } else if (key == "service-jobs") {
+        config.serviceJobs = parseConfigNumber<size_t>(key, value);
+    } else if (key == "service-deadline-ms") {
+        config.serviceDeadlineMs = parseConfigNumber<double>(key, value);
+    } else if (key == "auto-sort-config") {
+        config.autoSortConfigFile = value;
+    } else if (key == "tune-auto-sort") {
+        config.tuneAutoSort = parseConfigBool(key, value);
+    } else if (key == "distributed") {
+        config.runDistributedSort = parseConfigBool(key, value);
+    } else if (key == "distributed-shards") {
+        config.distributedShardPattern = value;
+    } else {
+        throw std::runtime_error("Ошибка: Неизвестный параметр: " + key);
+    }
+}
+
+
+/**
+ * @brief Загружает параметры из файла конфигурации (строки "ключ = значение", # - комментарий).
+ * @throws std::runtime_error Если файл не удается открыть или он содержит некорректную строку.
+ */
+void loadBenchmarkConfigFile(const std::string& filename, BenchmarkConfig& config) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Ошибка: Не удалось открыть файл конфигурации: " + filename);
+    }
+    auto trim = [](std::string text) {
+        size_t begin = text.find_first_not_of(" \t\r");
+        size_t end = text.find_last_not_of(" \t\r");
+        return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+    };
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+        size_t separator = line.find('=');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Ошибка: Некорректная строка в файле конфигурации " + filename + ": " + line);
+        }
+        applyBenchmarkOption(config, trim(line.substr(0, separator)), trim(line.substr(separator + 1)));
+    }
+}
+
+
+/**
+ * @brief Разбирает аргументы командной строки.
+ * @return False, если запрошена справка (--help) и замеры запускать не нужно.
+ * @throws std::runtime_error При неизвестном параметре или некорректном значении.
+ */
+bool parseBenchmarkArguments(int argc, char* argv[], BenchmarkConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--help" || argument == "-h") {
+            printBenchmarkUsage(std::cout, argv[0]);
+            return false;
+        }
+        if (argument.rfind("--", 0) != 0 || argument.find('=') == std::string::npos) {
+            throw std::runtime_error("Ошибка: Ожидался параметр вида --ключ=значение: " + argument);
+        }
+        size_t separator = argument.find('=');
+        applyBenchmarkOption(config, argument.substr(2, separator - 2), argument.substr(separator + 1));
+    }
+    return true;
 }
 
 
+/**
+ * @brief Бюджет времени на алгоритмы: прогнозирует время замера на следующем размере по предыдущему
+ * (t * (n / n_prev)^p, где p = 2 для O(n^2) сортировок и 1 для остальных) и отключает алгоритм,
+ * как только прогноз превышает бюджет. Размеры перебираются по возрастанию, так что отключенный
+ * алгоритм больше не запускается.
+ */
+class TimeBudget {
+public:
+    explicit TimeBudget(double budgetMs) : budgetMs(budgetMs) {}
+
+    /**
+     * @brief Решает, запускать ли алгоритм на наборе размера datasetSize.
+     * @param key Ключ алгоритма (название, потоки, распределение).
+     * @param datasetSize Размер набора.
+     * @param runs Прогревочные и замеряемые запуски.
+     * @param quadratic True для O(n^2) сортировок.
+     */
+    bool allows(const std::string& key, size_t datasetSize, int runs, bool quadratic) {
+        if (budgetMs <= 0.0) return true;
+        auto it = history.find(key);
+        if (it == history.end()) return true;
+        if (it->second.exhausted) return false;
+        double ratio = static_cast<double>(datasetSize) / static_cast<double>(std::max<size_t>(it->second.datasetSize, 1));
+        double predictedMs = it->second.medianMs * (quadratic ? ratio * ratio : ratio) * std::max(runs, 1);
+        if (predictedMs > budgetMs) {
+            it->second.exhausted = true;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Запоминает медиану последнего замера алгоритма.
+     */
+    void record(const std::string& key, size_t datasetSize, double medianMs) {
+        history[key] = {datasetSize, medianMs, false};
+    }
+
+private:
+    struct Entry {
+        size_t datasetSize;
+        double medianMs;
+        bool exhausted;
+    };
+    double budgetMs;
+    std::map<std::string, Entry> history;
+};
+
+
 /**
  * @brief Главная функция программы.
  * Загружает данные разного размера из файлов, проводит эксперименты по сортировке
- * для всех заданных алгоритмов и сохраняет результаты замеров времени.
+ * для выбранных алгоритмов и сохраняет результаты замеров времени.
+ * Параметры запуска задаются аргументами командной строки (см. printBenchmarkUsage()).
  */
-int main() {
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
+#endif
     //setlocale(LC_ALL, "Russian");
 
-    const std::vector<int> datasetSizes = {
-        100, 8100, 16100, 24100, 32100, 40100, 48100,
-        56100, 64100, 72100, 80100, 88100, 96100
-    };
+    BenchmarkConfig config;
+    try {
+        if (!parseBenchmarkArguments(argc, argv, config)) return 0;
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        printBenchmarkUsage(std::cerr, argv[0]);
+        return 1;
+    }
+
+    const std::vector<int>& datasetSizes = config.datasetSizes;
+
+    const std::string& DATASETS_DIR = config.datasetsDir;
+    const std::string& FILENAME_PATTERN = config.filenamePattern;
+    const std::string& BINARY_EXTENSION = config.binaryExtension;
+
+    const std::string OUTPUT_FILENAME_BASE = config.resultsDir + "sorted_services";
+    const std::string TIMING_RESULTS_FILENAME = config.resultsDir + "timing_results_bvg_all.csv";
+    const std::string LOAD_TIMING_RESULTS_FILENAME = config.resultsDir + "load_timing_results.csv";
+    const std::string SAVE_TIMING_RESULTS_FILENAME = config.resultsDir + "save_timing_results.csv";
+    const std::string EXTERNAL_SORT_RESULTS_FILENAME = config.resultsDir + "external_sort_results.csv";
+    const std::string PIPELINE_RESULTS_FILENAME = config.resultsDir + "pipeline_results.csv";
+    const std::string SCALING_RESULTS_FILENAME = config.resultsDir + "scaling_results.csv";
+    const std::string TOP_K_RESULTS_FILENAME = config.resultsDir + "top_k_results.csv";
+    const std::string SORT_SPEC_RESULTS_FILENAME = config.resultsDir + "sort_spec_results.csv";
+    const std::string SORTED_INDEX_RESULTS_FILENAME = config.resultsDir + "sorted_index_results.csv";
+    const std::string COLLATION_RESULTS_FILENAME = config.resultsDir + "collation_results.csv";
+    const std::string GPU_RESULTS_FILENAME = config.resultsDir + "gpu_results.csv";
+    const std::string SORT_REDUCE_RESULTS_FILENAME = config.resultsDir + "sort_reduce_results.csv";
+    const std::string SORT_SERVICE_RESULTS_FILENAME = config.resultsDir + "sort_service_results.csv";
+    const std::string AUTO_SORT_RESULTS_FILENAME = config.resultsDir + "auto_sort_results.csv";
+    const std::string DISTRIBUTED_RESULTS_FILENAME = config.resultsDir + "distributed_results.csv";
+
+    const int WARMUP_RUNS = config.warmupRuns;
+    const int REPETITIONS = config.repetitions;
+    const int QUADRATIC_WARMUP_RUNS = config.quadraticWarmupRuns;
+    const int QUADRATIC_REPETITIONS = config.quadraticRepetitions;
+    const ExternalSortConfig& externalSortConfig = config.externalSort;
+
+    // 0 в --threads означает число аппаратных потоков; дальше все замеры получают только положительные значения.
+    unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts = config.threadCounts;
+    if (threadCounts.empty()) {
+        threadCounts = {1, 2, 4, 8, 16, hardwareThreads};
+    }
+    for (unsigned& threads : threadCounts) {
+        if (threads == 0) threads = hardwareThreads;
+    }
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+    // autoSort использует наибольшее из заданных --threads, а без них - все аппаратные потоки.
+    unsigned autoSortThreads = config.threadCounts.empty() ? hardwareThreads : threadCounts.back();
+
+    if (!config.generateSizes.empty()) {
+        // Образец - самый большой из заданных наборов.
+        int templateSize = *std::max_element(datasetSizes.begin(), datasetSizes.end());
+        std::string templateFilename = DATASETS_DIR + FILENAME_PATTERN + std::to_string(templateSize) + ".csv";
+        std::vector<Service> templates;
+        try {
+            if (!loadServices(templateFilename, templates)) {
+                std::cerr << "Ошибка: Файл-образец пуст: " << templateFilename << std::endl;
+                return 1;
+            }
+            for (size_t size : config.generateSizes) {
+                std::string generatedFilename = DATASETS_DIR + FILENAME_PATTERN + std::to_string(size) + ".csv";
+                if (!saveServicesFast(generatedFilename, generateServices(templates, size), true)) return 1;
+                std::cout << "Сгенерирован набор " << generatedFilename << " (" << size << " записей по образцу " << templateFilename << ")." << std::endl;
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (config.tuneAutoSort) {
+        int templateSize = *std::max_element(datasetSizes.begin(), datasetSizes.end());
+        std::string templateFilename = DATASETS_DIR + FILENAME_PATTERN + std::to_string(templateSize) + ".csv";
+        std::vector<Service> templates;
+        try {
+            if (!loadServices(templateFilename, templates)) {
+                std::cerr << "Ошибка: Файл-образец пуст: " << templateFilename << std::endl;
+                return 1;
+            }
+            std::cout << "Калибровка порогов autoSort по образцу " << templateFilename << " (" << autoSortThreads << " потоков)..." << std::endl;
+            AutoSortThresholds tuned = tuneAutoSort(templates, autoSortThreads, REPETITIONS);
+            std::ostringstream comment;
+            comment << "Пороги autoSort: профиль " << SORT_BENCH_BUILD_PROFILE << ", компилятор " << compilerDescription()
+                    << ", потоков " << autoSortThreads;
+            if (!saveAutoSortThresholds(config.autoSortConfigFile, tuned, comment.str())) return 1;
+            std::cout << "Пороги сохранены в " << config.autoSortConfigFile << ": вставки до " << tuned.insertionMaxSize
+                      << ", поразрядная от " << tuned.radixMinSize << ", параллельная от " << tuned.parallelMinSize << "." << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
-    const std::string DATASETS_DIR = "datasets/";
-    const std::string FILENAME_PATTERN = "it_services_dataset_diverse_";
+    if (config.topKQuery > 0) {
+        bool allSaved = true;
+        for (int size : datasetSizes) {
+            std::string filename = DATASETS_DIR + FILENAME_PATTERN + std::to_string(size) + ".csv";
+            std::string outputFilename = OUTPUT_FILENAME_BASE + "_" + std::to_string(size) + "_top_" + std::to_string(config.topKQuery) + ".csv";
+            try {
+                std::vector<Service> cheapest;
+                auto start = std::chrono::steady_clock::now();
+                bool ok = topKStreaming(filename, config.topKQuery, cheapest) && saveServicesFast(outputFilename, cheapest);
+                auto end = std::chrono::steady_clock::now();
+                if (ok) {
+                    std::cout << cheapest.size() << " самых дешевых услуг из " << filename << " сохранены в " << outputFilename << " за "
+                              << std::fixed << std::setprecision(4) << std::chrono::duration<double, std::milli>(end - start).count() << " мс." << std::endl;
+                } else {
+                    std::cerr << "Не удалось выбрать " << config.topKQuery << " записей из " << filename << std::endl;
+                    allSaved = false;
+                }
+            } catch (const std::runtime_error& e) {
+                std::cerr << e.what() << std::endl;
+                allSaved = false;
+            }
+        }
+        return allSaved ? 0 : 1;
+    }
 
-    const std::string OUTPUT_FILENAME_BASE = "results/sorted_services";
-    const std::string TIMING_RESULTS_FILENAME = "results/timing_results_bvg_all.csv";
+    if (config.runDistributedSort) {
+#ifdef SORT_BENCH_HAVE_MPI
+        MPI_Init(&argc, &argv);
+        int rank = 0;
+        int ranks = 1;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+        std::string shardFilename = config.distributedShardPattern;
+        bool stripe = shardFilename.empty();
+        if (stripe) {
+            int largestSize = *std::max_element(datasetSizes.begin(), datasetSizes.end());
+            shardFilename = DATASETS_DIR + FILENAME_PATTERN + std::to_string(largestSize) + ".csv";
+        } else if (size_t placeholder = shardFilename.find("{rank}"); placeholder != std::string::npos) {
+            shardFilename.replace(placeholder, 6, std::to_string(rank));
+        }
+        std::string outputFilename = OUTPUT_FILENAME_BASE + "_distributed_" + std::to_string(rank) + "_of_" + std::to_string(ranks) + ".csv";
+        if (rank == 0) {
+            std::cout << "Распределенная сортировка на " << ranks << " узлах ("
+                      << (stripe ? "доли " + shardFilename : config.distributedShardPattern) << ")..." << std::endl;
+        }
+        DistributedSortStats distributedStats;
+        bool ok = false;
+        try {
+            ok = distributedSort(MPI_COMM_WORLD, shardFilename, stripe, outputFilename, distributedStats);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Узел " << rank << ": " << e.what() << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        reportDistributedSort(MPI_COMM_WORLD, distributedStats, DISTRIBUTED_RESULTS_FILENAME);
+        int localFailed = ok ? 0 : 1;
+        int failed = 0;
+        MPI_Allreduce(&localFailed, &failed, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        MPI_Finalize();
+        return failed ? 1 : 0;
+#else
+        std::cerr << "Ошибка: Распределенная сортировка требует сборки с SORT_BENCH_WITH_MPI." << std::endl;
+        return 1;
+#endif
+    }
 
     std::ofstream timingFile(TIMING_RESULTS_FILENAME, std::ios::binary);
     if (!timingFile.is_open()) {
@@ -331,10 +7752,118 @@ int main() {
         return 1;
     }
 
-    timingFile << "DatasetSize,Algorithm,TimeMilliseconds\n";
+    timingFile << "DatasetSize,Distribution,Algorithm,Threads,Repetitions,TimeMilliseconds,MinMs,MedianMs,P95Ms,StdDevMs,Comparisons,Swaps,Moves,Cycles,Instructions,L1DMisses,LLCMisses,BranchMisses,"
+               << allocationCsvHeader("Load") << "," << allocationCsvHeader("Copy") << "," << allocationCsvHeader("Sort") << ",BuildProfile,Compiler\n";
     std::cout << "Файл для сохранения результатов замеров времени '" << TIMING_RESULTS_FILENAME << "' успешно открыт." << std::endl;
+    std::cout << "Сборка: профиль " << SORT_BENCH_BUILD_PROFILE << ", компилятор " << compilerDescription() << "." << std::endl;
+
+    std::ofstream loadTimingFile(LOAD_TIMING_RESULTS_FILENAME, std::ios::binary);
+    if (!loadTimingFile.is_open()) {
+        std::cerr << "Ошибка: Не удалось открыть файл для записи результатов замеров загрузки: " << LOAD_TIMING_RESULTS_FILENAME << std::endl;
+        return 1;
+    }
+    loadTimingFile << "DatasetSize,Loader,Threads,TimeMilliseconds,MegabytesPerSecond\n";
+
+    // SIMD-сортировка замеряется на всех наборах инструкций до лучшего доступного включительно.
+    SimdLevel bestSimdLevel = detectSimdLevel();
+    std::vector<SimdLevel> simdLevels = {SimdLevel::Scalar};
+    if (bestSimdLevel == SimdLevel::Avx2 || bestSimdLevel == SimdLevel::Avx512) simdLevels.push_back(SimdLevel::Avx2);
+    if (bestSimdLevel == SimdLevel::Avx512) simdLevels.push_back(SimdLevel::Avx512);
+    std::cout << "SIMD-ядро сортировки: " << simdLevelName(bestSimdLevel) << "." << std::endl;
+
+#ifdef SORT_BENCH_HAVE_CUDA
+    std::string gpuDeviceName;
+    bool gpuAvailable = config.algorithmEnabled("gpu") && gpuSortAvailable(&gpuDeviceName);
+    std::ofstream gpuFile;
+    if (gpuAvailable) {
+        std::cout << "GPU-сортировка: " << gpuDeviceName << "." << std::endl;
+        gpuFile.open(GPU_RESULTS_FILENAME, std::ios::binary);
+        gpuFile << "DatasetSize,ExtractMs,UploadMs,KernelMs,DownloadMs,PermuteMs,TransferMs,TotalMs\n";
+    } else if (config.algorithmEnabled("gpu")) {
+        std::cerr << "Предупреждение: Устройство CUDA не найдено, GPU-сортировка пропущена." << std::endl;
+    }
+#else
+    if (!config.algorithms.empty() && config.algorithmEnabled("gpu")) {
+        std::cerr << "Предупреждение: Сборка без SORT_BENCH_WITH_CUDA, GPU-сортировка пропущена." << std::endl;
+    }
+#endif
+
+    AutoSortThresholds autoSortThresholds;
+    // Общий пул autoSort: запуск потоков не попадает в замеры и в SortMs.
+    WorkStealingPool autoSortPool(config.algorithmEnabled("auto") ? autoSortThreads - 1 : 0);
+    std::ofstream autoSortLog;
+    if (config.algorithmEnabled("auto")) {
+        try {
+            if (loadAutoSortThresholds(config.autoSortConfigFile, autoSortThresholds)) {
+                std::cout << "Пороги autoSort загружены из " << config.autoSortConfigFile << "." << std::endl;
+            } else {
+                std::cout << "Файл порогов " << config.autoSortConfigFile
+                          << " не найден, autoSort использует пороги по умолчанию (см. --tune-auto-sort)." << std::endl;
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        autoSortLog.open(AUTO_SORT_RESULTS_FILENAME, std::ios::binary);
+        autoSortLog << "DatasetSize,Distribution,Algorithm,Reason,SampleSize,SampleRuns,DescentRatio,DuplicateRatio,Threads,ProfileMs,SortMs,TotalMs\n";
+    }
+    // Записывает решение autoSort и время его этапов.
+    auto reportAutoSort = [&](size_t datasetSize, const std::string& distribution, const AutoSortDecision& decision) {
+        const DataProfile& profile = decision.profile;
+        autoSortLog << datasetSize << "," << distribution << "," << autoSortAlgorithmName(decision.algorithm) << "," << decision.reason << ","
+                    << profile.sampleSize << "," << profile.sampleRuns << "," << std::fixed << std::setprecision(4) << profile.descentRatio << ","
+                    << profile.duplicateRatio << "," << profile.threads << "," << decision.profileMs << ","
+                    << decision.sortMs << "," << (decision.profileMs + decision.sortMs) << "\n";
+    };
+
+    std::unique_ptr<HardwareCounters> hardwareCountersOwner;
+    if (config.collectHardwareCounters) {
+        hardwareCountersOwner = std::make_unique<HardwareCounters>();
+        if (!hardwareCountersOwner->anyAvailable()) {
+            std::cerr << "Предупреждение: Аппаратные счетчики производительности недоступны, столбцы счетчиков останутся пустыми." << std::endl;
+            hardwareCountersOwner.reset();
+        }
+    }
+    HardwareCounters* hardwareCounters = hardwareCountersOwner.get();
+
+    AllocationStats currentLoadMemory;   // Выделения при загрузке текущего набора (столбцы Load* в CSV)
+
+    // Запускает замер, если алгоритм выбран и укладывается в бюджет времени, и записывает результат.
+    TimeBudget timeBudget(config.timeBudgetMs);
+    auto runSort = [&](const std::string& id, const std::string& algorithmName, size_t datasetSize, unsigned threads,
+                       bool quadratic, auto measure, DatasetDistribution distribution = DatasetDistribution::Random) {
+        if (!config.algorithmEnabled(id)) return;
+        std::string budgetKey = algorithmName + "|" + std::to_string(threads) + "|" + distributionName(distribution);
+        int runs = quadratic ? QUADRATIC_WARMUP_RUNS + QUADRATIC_REPETITIONS : WARMUP_RUNS + REPETITIONS;
+        if (!timeBudget.allows(budgetKey, datasetSize, runs, quadratic)) {
+            std::cout << algorithmName << ": пропуск, прогноз времени превышает бюджет " << std::fixed << std::setprecision(0)
+                      << config.timeBudgetMs << " мс." << std::setprecision(4) << std::endl;
+            return;
+        }
+        TimingStats stats = measure();
+        stats.loadMemory = currentLoadMemory;
+        timeBudget.record(budgetKey, datasetSize, stats.medianMs);
+        reportTiming(timingFile, datasetSize, algorithmName, threads, stats, distribution);
+    };
+
+    // Замеряет autoSort и записывает решение, принятое в последнем запуске.
+    auto runAutoSort = [&](const std::vector<Service>& data, size_t datasetSize, DatasetDistribution distribution) {
+        AutoSortDecision decision;
+        bool measured = false;
+        runSort("auto", "Автовыбор алгоритма (autoSort)", datasetSize, autoSortThreads, false, [&]() {
+            measured = true;
+            return timeSort([&](std::vector<Service>& vec){ decision = autoSort(vec, autoSortThresholds, autoSortPool); },
+                            data, "Автовыбор алгоритма (autoSort)", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+        }, distribution);
+        if (measured) {
+            std::cout << "autoSort: " << autoSortAlgorithmName(decision.algorithm) << " (" << decision.reason << ")." << std::endl;
+            reportAutoSort(datasetSize, distributionName(distribution), decision);
+        }
+    };
 
     std::vector<Service> currentData;
+    std::string lastLoadedFilename;
+    StableMergeSorter<Service> stableSorter;   // Буфер переиспользуется между запусками и наборами
 
     for (int currentSize_int : datasetSizes) {
         size_t currentSize = static_cast<size_t>(currentSize_int);
@@ -342,8 +7871,26 @@ int main() {
 
         std::cout << "\n--- Обработка файла: " << filename << " (размер: " << currentSize << ") ---" << std::endl;
 
+        std::string binaryFilename = DATASETS_DIR + FILENAME_PATTERN + std::to_string(currentSize) + BINARY_EXTENSION;
         try {
-            if (!loadServices(filename, currentData)) {
+            std::vector<Service>().swap(currentData);   // Выделения загрузки считаются с нуля
+            AllocationScope loadScope;
+            bool loaded = loadServicesBinary(binaryFilename, filename, currentData);
+            if (loaded) {
+                currentLoadMemory = loadScope.stats();
+                std::cout << "Данные загружены из бинарного файла " << binaryFilename << "." << std::endl;
+            } else {
+                loaded = loadServices(filename, currentData);
+                currentLoadMemory = loadScope.stats();
+                if (loaded) {
+                    if (convertCsvToBinary(filename, binaryFilename)) {
+                        std::cout << "Создан бинарный файл " << binaryFilename << "." << std::endl;
+                    } else {
+                        std::cerr << "Предупреждение: Не удалось создать бинарный файл " << binaryFilename << "." << std::endl;
+                    }
+                }
+            }
+            if (!loaded) {
                 std::cerr << "Пропуск экспериментов для размера " << currentSize << " из-за ошибки загрузки или пустого файла." << std::endl;
                 continue;
             }
@@ -351,28 +7898,136 @@ int main() {
                  std::cerr << "Предупреждение: Ожидалось " << currentSize << " записей в файле, но загружено " << currentData.size() << "." << std::endl;
                  currentSize = currentData.size();
              }
-            std::cout << "Загружено " << currentData.size() << " записей." << std::endl;
+            std::cout << "Загружено " << currentData.size() << " записей";
+            if (allocationTrackingEnabled()) {
+                std::cout << " (выделений: " << currentLoadMemory.allocations << ", " << std::fixed << std::setprecision(1)
+                          << currentLoadMemory.bytes / 1048576.0 << " МБ)" << std::setprecision(4);
+            }
+            std::cout << "." << std::endl;
+            lastLoadedFilename = filename;
         } catch (const std::runtime_error& e) {
             std::cerr << e.what() << std::endl;
             std::cerr << "Пропуск экспериментов для размера " << currentSize << " из-за ошибки открытия файла." << std::endl;
             continue;
         }
 
-        double bubbleTime = timeSort(bubbleSort, currentData, "Сортировка пузырьком");
-        std::cout << "Сортировка пузырьком завершена за " << std::fixed << std::setprecision(4) << bubbleTime << " мс." << std::endl;
-        timingFile << currentSize << "," << "\"Сортировка пузырьком\"" << "," << std::fixed << std::setprecision(4) << bubbleTime << "\n";
+        if (config.runLoadBenchmark) {
+            runLoadBenchmark(loadTimingFile, filename, binaryFilename, currentSize, currentData.size(), threadCounts);
+        }
+
+        runSort("bubble", "Сортировка пузырьком", currentSize, 1, true, [&]() {
+            return timeSort(bubbleSort, currentData, "Сортировка пузырьком", QUADRATIC_WARMUP_RUNS, QUADRATIC_REPETITIONS, hardwareCounters);
+        });
+        runSort("insertion", "Сортировка вставками", currentSize, 1, true, [&]() {
+            return timeSort(insertionSort, currentData, "Сортировка вставками", QUADRATIC_WARMUP_RUNS, QUADRATIC_REPETITIONS, hardwareCounters);
+        });
+        runSort("shaker", "Шейкер-сортировка", currentSize, 1, true, [&]() {
+            return timeSort(shakerSort, currentData, "Шейкер-сортировка", QUADRATIC_WARMUP_RUNS, QUADRATIC_REPETITIONS, hardwareCounters);
+        });
+
+        runSort("std_sort", "std::sort", currentSize, 1, false, [&]() {
+            return timeSort([](std::vector<Service>& vec){ std::sort(vec.begin(), vec.end()); }, currentData, "std::sort", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+        });
+        runSort("key_sort", "std::sort (извлеченные ключи)", currentSize, 1, false, [&]() {
+            return timeSort(keySort, currentData, "std::sort (извлеченные ключи)", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+        });
+        runSort("radix", "Поразрядная сортировка", currentSize, 1, false, [&]() {
+            return timeSort(radixSort, currentData, "Поразрядная сортировка", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+        });
+        runSort("adaptive", "Адаптивная гибридная сортировка", currentSize, 1, false, [&]() {
+            return timeSort([](std::vector<Service>& vec){ adaptiveSort(vec); }, currentData, "Адаптивная гибридная сортировка", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+        });
+        runSort("stable_std", "std::stable_sort", currentSize, 1, false, [&]() {
+            return timeSort(stableStdSort, currentData, "std::stable_sort", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+        });
+        runSort("stable_merge", "Стабильное слияние (буфер сохраняется)", currentSize, 1, false, [&]() {
+            return timeSort([&stableSorter](std::vector<Service>& vec){ stableMergeSort(vec, stableSorter); }, currentData, "Стабильное слияние (буфер сохраняется)", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+        });
+        runSort("stable_inplace", "Стабильное слияние на месте", currentSize, 1, false, [&]() {
+            return timeSort([](std::vector<Service>& vec){ inPlaceStableSort(vec); }, currentData, "Стабильное слияние на месте", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+        });
+        for (SimdLevel level : simdLevels) {
+            std::string simdName = std::string("SIMD-сортировка (") + simdLevelName(level) + ")";
+            runSort("simd", simdName, currentSize, 1, false, [&]() {
+                return timeSort([level](std::vector<Service>& vec){ simdSort(vec, level); }, currentData, simdName, WARMUP_RUNS, REPETITIONS, hardwareCounters);
+            });
+        }
+#ifdef SORT_BENCH_HAVE_CUDA
+        if (gpuAvailable) {
+            std::vector<GpuSortTimings> gpuRuns;
+            gpuRuns.reserve(WARMUP_RUNS + REPETITIONS);
+            try {
+                runSort("gpu", "Поразрядная сортировка (GPU)", currentSize, 1, false, [&]() {
+                    return timeSort([&gpuRuns](std::vector<Service>& vec){ gpuRuns.emplace_back(); gpuSort(vec, &gpuRuns.back()); },
+                                    currentData, "Поразрядная сортировка (GPU)", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+                });
+            } catch (const std::runtime_error& e) {
+                std::cerr << e.what() << " GPU-сортировка отключена." << std::endl;
+                gpuAvailable = false;
+            }
+            if (gpuAvailable && gpuRuns.size() > static_cast<size_t>(WARMUP_RUNS)) {
+                reportGpuTiming(gpuFile, currentSize, std::vector<GpuSortTimings>(gpuRuns.begin() + WARMUP_RUNS, gpuRuns.end()));
+            }
+        }
+#endif
+
+        if (config.algorithmEnabled("pooled")) {
+            PooledServices currentPooled = PooledServices::fromServices(currentData);
+            {
+                auto copyStart = std::chrono::steady_clock::now();
+                std::vector<Service> vectorCopy = currentData;
+                auto copyMiddle = std::chrono::steady_clock::now();
+                PooledServices pooledCopy = currentPooled;
+                auto copyEnd = std::chrono::steady_clock::now();
+                std::cout << "Копирование набора данных: std::vector<Service> " << std::fixed << std::setprecision(4)
+                          << std::chrono::duration<double, std::milli>(copyMiddle - copyStart).count() << " мс, арена названий "
+                          << std::chrono::duration<double, std::milli>(copyEnd - copyMiddle).count() << " мс." << std::endl;
+            }
+            runSort("pooled", "std::sort (арена названий)", currentSize, 1, false, [&]() {
+                return timeSort([](PooledServices& dataset){ std::sort(dataset.records.begin(), dataset.records.end()); },
+                                currentPooled, "std::sort (арена названий)", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+            });
+        }
+
+        if (config.algorithmEnabled("soa") || config.algorithmEnabled("soa_radix")) {
+            ServiceTable currentTable = ServiceTable::fromServices(currentData);
+            runSort("soa", "std::sort (SoA)", currentSize, 1, false, [&]() {
+                return timeSort(sortTable, currentTable, "std::sort (SoA)", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+            });
+            runSort("soa_radix", "Поразрядная сортировка (SoA)", currentSize, 1, false, [&]() {
+                return timeSort(radixSortTable, currentTable, "Поразрядная сортировка (SoA)", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+            });
+        }
 
-        double insertionTime = timeSort(insertionSort, currentData, "Сортировка вставками");
-        std::cout << "Сортировка вставками завершена за " << std::fixed << std::setprecision(4) << insertionTime << " мс." << std::endl;
-        timingFile << currentSize << "," << "\"Сортировка вставками\"" << "," << std::fixed << std::setprecision(4) << insertionTime << "\n";
+        for (unsigned threads : threadCounts) {
+            // Пул создается один раз на число потоков: запуск и остановка потоков не попадают в замеры.
+            WorkStealingPool pool(threads - 1);
+            runSort("par_std", "std::sort (par_unseq)", currentSize, threads, false, [&]() {
+                return timeSort([threads](std::vector<Service>& vec){ parallelStdSort(vec, threads); }, currentData, "std::sort (par_unseq)", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+            });
+            runSort("par_merge", "Параллельная сортировка слиянием", currentSize, threads, false, [&]() {
+                return timeSort([&pool](std::vector<Service>& vec){ parallelMergeSort(vec, pool); }, currentData, "Параллельная сортировка слиянием", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+            });
+            runSort("sample", "Параллельная выборочная сортировка", currentSize, threads, false, [&]() {
+                return timeSort([&pool](std::vector<Service>& vec){ parallelSampleSort(vec, std::less<Service>(), pool); }, currentData, "Параллельная выборочная сортировка", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+            });
+        }
 
-        double shakerTime = timeSort(shakerSort, currentData, "Шейкер-сортировка");
-        std::cout << "Шейкер-сортировка завершена за " << std::fixed << std::setprecision(4) << shakerTime << " мс." << std::endl;
-        timingFile << currentSize << "," << "\"Шейкер-сортировка\"" << "," << std::fixed << std::setprecision(4) << shakerTime << "\n";
+        runAutoSort(currentData, currentSize, DatasetDistribution::Random);
 
-        double stdSortTime = timeSort( [](std::vector<Service>& vec){ std::sort(vec.begin(), vec.end()); }, currentData, "std::sort");
-        std::cout << "std::sort завершена за " << std::fixed << std::setprecision(4) << stdSortTime << " мс." << std::endl;
-        timingFile << currentSize << "," << "\"std::sort\"" << "," << std::fixed << std::setprecision(4) << stdSortTime << "\n";
+        if (config.runDistributionBenchmark && (config.algorithmEnabled("std_sort") || config.algorithmEnabled("adaptive")
+                                                || config.algorithmEnabled("auto"))) {
+            for (DatasetDistribution distribution : {DatasetDistribution::NearlySorted, DatasetDistribution::Reversed, DatasetDistribution::FewUnique}) {
+                std::vector<Service> variantData = makeDatasetVariant(currentData, distribution);
+                runSort("std_sort", "std::sort", currentSize, 1, false, [&]() {
+                    return timeSort([](std::vector<Service>& vec){ std::sort(vec.begin(), vec.end()); }, variantData, "std::sort", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+                }, distribution);
+                runSort("adaptive", "Адаптивная гибридная сортировка", currentSize, 1, false, [&]() {
+                    return timeSort([](std::vector<Service>& vec){ adaptiveSort(vec); }, variantData, "Адаптивная гибридная сортировка", WARMUP_RUNS, REPETITIONS, hardwareCounters);
+                }, distribution);
+                runAutoSort(variantData, currentSize, distribution);
+            }
+        }
 
         timingFile.flush();
     }
@@ -383,7 +8038,35 @@ int main() {
         try {
             std::vector<Service> finalSortedData = currentData;
             std::sort(finalSortedData.begin(), finalSortedData.end());
-            if (saveServices(outputFilename, finalSortedData)) {
+
+            std::ofstream saveTimingFile;
+            if (config.runSaveBenchmark) saveTimingFile.open(SAVE_TIMING_RESULTS_FILENAME, std::ios::binary);
+            saveTimingFile << "DatasetSize,Writer,TimeMilliseconds,MegabytesPerSecond," << allocationCsvHeader("Save") << "\n";
+            auto timeSave = [&](const std::string& writerName, auto saveFunction) {
+                AllocationScope saveScope;
+                auto start = std::chrono::steady_clock::now();
+                bool saved = saveFunction();
+                auto end = std::chrono::steady_clock::now();
+                AllocationStats saveMemory = saveScope.stats();
+                double timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+                std::error_code sizeError;
+                double mbytes = static_cast<double>(std::filesystem::file_size(outputFilename, sizeError)) / 1048576.0;
+                double throughput = (timeMs > 0.0 && !sizeError) ? mbytes / (timeMs / 1000.0) : 0.0;
+                std::cout << writerName << ": " << std::fixed << std::setprecision(4) << timeMs << " мс, "
+                          << std::setprecision(1) << throughput << " МБ/с." << std::endl;
+                saveTimingFile << finalSortedData.size() << "," << "\"" << writerName << "\"" << ","
+                               << std::fixed << std::setprecision(4) << timeMs << "," << throughput;
+                writeAllocationCsvFields(saveTimingFile, saveMemory);
+                saveTimingFile << "\n";
+                return saved;
+            };
+            bool saved = true;
+            if (config.runSaveBenchmark) {
+                saved = timeSave("saveServices", [&]() { return saveServices(outputFilename, finalSortedData); });
+                saved = timeSave("saveServicesFast", [&]() { return saveServicesFast(outputFilename, finalSortedData, false); }) && saved;
+            }
+            saved = timeSave("saveServicesFast (фоновая запись)", [&]() { return saveServicesFast(outputFilename, finalSortedData, true); }) && saved;
+            if (saved) {
                 std::cout << "Отсортированные данные сохранены в " << outputFilename << std::endl;
             } else {
                 std::cerr << "Не удалось сохранить отсортированные данные в " << outputFilename << std::endl;
@@ -395,6 +8078,137 @@ int main() {
         std::cerr << "\nНет данных для сохранения финального отсортированного файла, так как ни один набор данных не был успешно загружен." << std::endl;
     }
 
+    if (config.runExternalSort && !lastLoadedFilename.empty()) {
+        std::string externalOutput = OUTPUT_FILENAME_BASE + "_" + std::to_string(currentData.size()) + "_external_sort.csv";
+        std::cout << "\nВнешняя сортировка " << lastLoadedFilename << " (бюджет памяти " << externalSortConfig.memoryBudgetBytes << " байт)..." << std::endl;
+        try {
+            ExternalSortStats externalStats;
+            if (externalSort(lastLoadedFilename, externalOutput, externalSortConfig, externalStats)) {
+                std::cout << "Внешняя сортировка: " << externalStats.records << " записей, " << externalStats.runs << " серий, "
+                          << externalStats.mergePasses << " проходов слияния, формирование серий " << std::fixed << std::setprecision(4)
+                          << externalStats.runPhaseMs << " мс, слияние " << externalStats.mergePhaseMs << " мс. Результат: " << externalOutput << std::endl;
+                std::ofstream externalFile(EXTERNAL_SORT_RESULTS_FILENAME, std::ios::binary);
+                externalFile << "DatasetSize,MemoryBudgetBytes,Runs,MergePasses,RunPhaseMs,MergePhaseMs,TotalMs\n";
+                externalFile << externalStats.records << "," << externalSortConfig.memoryBudgetBytes << "," << externalStats.runs << ","
+                             << externalStats.mergePasses << "," << std::fixed << std::setprecision(4) << externalStats.runPhaseMs << ","
+                             << externalStats.mergePhaseMs << "," << (externalStats.runPhaseMs + externalStats.mergePhaseMs) << "\n";
+            } else {
+                std::cerr << "Не удалось выполнить внешнюю сортировку " << lastLoadedFilename << std::endl;
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Ошибка внешней сортировки: " << e.what() << std::endl;
+        }
+    }
+
+    if (config.algorithmEnabled("auto") && !lastLoadedFilename.empty()) {
+        std::string autoOutput = OUTPUT_FILENAME_BASE + "_" + std::to_string(currentData.size()) + "_auto_sort.csv";
+        try {
+            AutoSortDecision decision;
+            if (autoSortFile(lastLoadedFilename, autoOutput, autoSortThresholds, externalSortConfig, autoSortPool, decision)) {
+                std::cout << "\nautoSort файла " << lastLoadedFilename << ": " << autoSortAlgorithmName(decision.algorithm) << " ("
+                          << decision.reason << "), " << std::fixed << std::setprecision(4) << decision.profileMs + decision.sortMs
+                          << " мс. Результат: " << autoOutput << std::endl;
+                reportAutoSort(decision.profile.size, "file", decision);
+            } else {
+                std::cerr << "Не удалось выполнить autoSort файла " << lastLoadedFilename << std::endl;
+            }
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Ошибка autoSort файла: " << e.what() << std::endl;
+        }
+    }
+
+    if (config.runTopKBenchmark && !lastLoadedFilename.empty()) {
+        std::cout << "\nВыборка K наименьших записей против полной сортировки (" << lastLoadedFilename << ")..." << std::endl;
+        std::ofstream topKFile(TOP_K_RESULTS_FILENAME, std::ios::binary);
+        topKFile << "DatasetSize,K,Source,Method,TimeMilliseconds,SpeedupVsFullSort\n";
+        try {
+            runTopKBenchmark(topKFile, lastLoadedFilename, currentData, REPETITIONS);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Ошибка замеров выборки: " << e.what() << std::endl;
+        }
+    }
+
+    if (config.runSortSpecBenchmark && !currentData.empty()) {
+        std::cout << "\nМногоключевые спецификации сортировки (" << currentData.size() << " записей)..." << std::endl;
+        std::ofstream specFile(SORT_SPEC_RESULTS_FILENAME, std::ios::binary);
+        specFile << "DatasetSize,Spec,Method,TimeMilliseconds,SpeedupVsRuntime\n";
+        runSortSpecBenchmark(specFile, currentData, WARMUP_RUNS, REPETITIONS);
+    }
+
+    if (config.runSortedIndexBenchmark && !currentData.empty() && config.indexBatches > 0) {
+        std::cout << "\nПакетные обновления отсортированного индекса (" << currentData.size() << " записей, "
+                  << config.indexBatches << " пакетов)..." << std::endl;
+        std::ofstream indexFile(SORTED_INDEX_RESULTS_FILENAME, std::ios::binary);
+        indexFile << "DatasetSize,BatchSize,Batches,Operation,Method,TotalMs,MsPerBatch,SpeedupVsResort\n";
+        runSortedIndexBenchmark(indexFile, currentData, config.indexBatchSizes, config.indexBatches);
+    }
+
+    if (config.runCollationBenchmark && !currentData.empty()) {
+        std::cout << "\nСортировка с ключами сопоставления названий (" << currentData.size() << " записей)..." << std::endl;
+        std::ofstream collationFile(COLLATION_RESULTS_FILENAME, std::ios::binary);
+        collationFile << "DatasetSize,Input,Collation,Method,TimeMilliseconds,KeyBuildMs,SpeedupVsComparator\n";
+        runCollationBenchmark(collationFile, currentData, WARMUP_RUNS, REPETITIONS);
+    }
+
+    if (config.runSortReduceBenchmark && !currentData.empty()) {
+        std::cout << "\nСортировка с удалением дубликатов и агрегатами по корзинам стоимости " << std::defaultfloat << config.costBucketWidth
+                  << " (" << currentData.size() << " записей)..." << std::endl;
+        std::ofstream reduceFile(SORT_REDUCE_RESULTS_FILENAME, std::ios::binary);
+        reduceFile << "DatasetSize,Input,Method,UniqueRecords,Buckets,TimeMilliseconds,SpeedupVsSeparate\n";
+        runSortReduceBenchmark(reduceFile, currentData, config.costBucketWidth, WARMUP_RUNS, REPETITIONS);
+    }
+
+    if (config.runSortServiceBenchmark && !currentData.empty() && config.serviceClients > 0 && config.serviceJobs > 0) {
+        std::cout << "\nНагрузочный тест асинхронного сервиса сортировки (" << config.serviceClients << " клиентов по "
+                  << config.serviceJobs << " заданий)..." << std::endl;
+        std::ofstream serviceFile(SORT_SERVICE_RESULTS_FILENAME, std::ios::binary);
+        serviceFile << "Mode,Workers,Clients,JobSize,Jobs,Completed,Expired,P50Ms,P99Ms,MeanMs,MeanQueueMs,MeanRunMs,JobsPerSecond\n";
+        runSortServiceBenchmark(serviceFile, currentData, config.serviceWorkers, config.serviceClients,
+                                config.serviceJobs, config.serviceDeadlineMs);
+    }
+
+    if (config.runPipelineBenchmark) {
+        std::vector<PipelineJob> pipelineJobs;
+        for (int size : datasetSizes) {
+            std::string stem = DATASETS_DIR + FILENAME_PATTERN + std::to_string(size);
+            pipelineJobs.push_back({stem + ".csv", stem + BINARY_EXTENSION,
+                                    OUTPUT_FILENAME_BASE + "_" + std::to_string(size) + "_pipeline.csv"});
+        }
+        auto pipelineSort = [](std::vector<Service>& vec) { std::sort(vec.begin(), vec.end()); };
+
+        std::cout << "\nОбработка всех наборов данных: загрузка -> std::sort -> сохранение..." << std::endl;
+        std::ofstream pipelineFile(PIPELINE_RESULTS_FILENAME, std::ios::binary);
+        pipelineFile << "Mode,QueueCapacity,Datasets,Records,WallMs,LoadBusyMs,SortBusyMs,SaveBusyMs,LoadUtilization,SortUtilization,SaveUtilization\n";
+        // Порядок ABBA: первый прогон прогревает кэш страниц, поэтому каждый режим выполняется и первым, и последним.
+        PipelineStats pipelineStats;
+        try {
+            for (bool pipelined : {false, true, true, false}) {
+                if (pipelined) {
+                    if (!runPipeline(pipelineJobs, pipelineSort, config.pipelineQueueCapacity, pipelineStats)) {
+                        std::cerr << "Предупреждение: Конвейерная обработка завершилась с ошибками." << std::endl;
+                    }
+                    reportPipeline(pipelineFile, "Конвейер", config.pipelineQueueCapacity, pipelineStats);
+                } else {
+                    if (!runSequentialPipeline(pipelineJobs, pipelineSort, pipelineStats)) {
+                        std::cerr << "Предупреждение: Последовательная обработка завершилась с ошибками." << std::endl;
+                    }
+                    reportPipeline(pipelineFile, "Последовательно", 0, pipelineStats);
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка конвейерной обработки: " << e.what() << std::endl;
+        }
+    }
+
+    if (config.runScalingBenchmark && !currentData.empty()) {
+        std::cout << "\nЗамеры масштабируемости (" << config.scalingSize << " записей, сгенерированы по образцу последнего набора)..." << std::endl;
+        std::ofstream scalingFile(SCALING_RESULTS_FILENAME, std::ios::binary);
+        scalingFile << "Mode,Algorithm,Threads,DatasetSize,TimeMilliseconds,Speedup,Efficiency\n";
+        size_t weakSizePerThread = config.scalingSize / *std::max_element(threadCounts.begin(), threadCounts.end());
+        runScalingBenchmark(scalingFile, currentData, config.scalingSize, weakSizePerThread, threadCounts, config.scalingRepetitions);
+    }
+
+    loadTimingFile.close();
     timingFile.close();
     std::cout << "\nФайл с результатами замеров времени '" << TIMING_RESULTS_FILENAME << "' закрыт." << std::endl;
 